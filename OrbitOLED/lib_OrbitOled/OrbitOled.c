@@ -76,6 +76,35 @@ char *	pbOledFontUser;
 */
 char	rgbOledBmp[cbOledDispMax];
 
+/* Range of columns in each page changed since the last update. A page
+** is clean when its first dirty column is past its last one.
+*/
+int		rgcolOledDirtyFirst[cpagOledMax];
+int		rgcolOledDirtyLast[cpagOledMax];
+
+/* Front buffer, the copy of the display contents being sent to the
+** display. Drawing goes to rgbOledBmp (the back buffer), and changes
+** are only copied across by OrbitOledPresent while no flush is reading
+** this one, so a page is never changed part way through being sent.
+*/
+char	rgbOledFront[cbOledDispMax];
+
+/* Column ranges of the front buffer waiting to be sent, taken from
+** the dirty ranges by OrbitOledPresent.
+*/
+int		rgcolOledSendFirst[cpagOledMax];
+int		rgcolOledSendLast[cpagOledMax];
+volatile int	fOledFlushPending;
+
+/* Called when a flush has been completely sent (from the SSI3
+** interrupt when using uDMA).
+*/
+void	(*pfnOledUpdateDone)(void);
+
+#if defined(ORBITOLED_UDMA)
+int		ipagOledSend;
+#endif
+
 /* ------------------------------------------------------------ */
 /*				Forward Declarations							*/
 /* ------------------------------------------------------------ */
@@ -85,6 +114,11 @@ void	OrbitOledDevInit();
 void	OrbitOledDvrInit();
 char	Ssi3PutByte(char bVal);
 void	OrbitOledPutBuffer(int cb, char * rgbTx);
+void	OrbitOledSetPage(int ipag, int col);
+#if defined(ORBITOLED_UDMA)
+void	OrbitOledSendNextPage();
+void	OrbitOledSsiIntHandler();
+#endif
 
 /* ------------------------------------------------------------ */
 /*				Procedure Definitions							*/
@@ -161,6 +195,18 @@ OrbitOledHostInit()
 	SSIConfigSetExpClk(SSI3_BASE, SysCtlClockGet(), SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER, 8000000, 8);
 	SSIEnable(SSI3_BASE);
 
+#if defined(ORBITOLED_UDMA)
+	/* Page data is written to the transmit FIFO by uDMA channel 15,
+	** and the SSI3 interrupt signals each transfer completing.
+	*/
+	uDMAChannelAssign(UDMA_CH15_SSI3TX);
+	uDMAChannelAttributeDisable(UDMA_CH15_SSI3TX, UDMA_ATTR_ALL);
+	uDMAChannelControlSet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT,
+						  UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+	SSIDMAEnable(SSI3_BASE, SSI_DMA_TX);
+	SSIIntRegister(SSI3_BASE, OrbitOledSsiIntHandler);
+#endif
+
 	/* Make power control pins be outputs with the supplies off
 	*/
 	GPIOPinWrite(VBAT_OLEDPort, VBAT_OLED, VBAT_OLED);
@@ -175,9 +221,11 @@ OrbitOledHostInit()
 	 * 2. Write to appropriate bit in the Commit Register (bit 7)
 	 * 3. Re-lock the GPIOLOCK register
 	*/
+#if !defined(HOST_BUILD)
 	HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = 0x4C4F434B;	// unlock
 	HWREG(GPIO_PORTD_BASE + GPIO_O_CR) |= 1 << 7; 		// allow writes
 	HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = 0x0;			// re-lock
+#endif
 	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
 	GPIOPinTypeGPIOOutput(nDC_OLEDPort, nDC_OLED);
 	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
@@ -238,6 +286,13 @@ OrbitOledDvrInit()
 	*/
 	fOledCharUpdate = 1;
 
+	/* Nothing has been drawn yet.
+	*/
+	for (ib = 0; ib < cpagOledMax; ib++) {
+		rgcolOledDirtyFirst[ib] = ccolOledMax;
+		rgcolOledDirtyLast[ib] = -1;
+	}
+
 }
 
 /* ------------------------------------------------------------ */
@@ -364,6 +419,56 @@ OrbitOledClearBuffer()
 		*pb++ = 0x00;
 	}
 
+	/* The display contents are unknown, so send all of it on the
+	** next update.
+	*/
+	for (ib = 0; ib < cpagOledMax; ib++) {
+		OrbitOledMarkDirty(&rgbOledBmp[ib * ccolOledMax], ccolOledMax);
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledMarkDirty
+**
+**	Parameters:
+**		pb		- first changed byte in the display buffer
+**		cb		- number of changed bytes, within the same page
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Record that part of a page of the display buffer has
+**		changed, so that the next update sends it to the display.
+*/
+
+void
+OrbitOledMarkDirty(char * pb, int cb)
+	{
+	int		ib;
+	int		ipag;
+	int		colFirst;
+	int		colLast;
+
+	ib = pb - rgbOledBmp;
+	ipag = ib / ccolOledMax;
+	colFirst = ib % ccolOledMax;
+	colLast = colFirst + cb - 1;
+	if (colLast >= ccolOledMax) {
+		colLast = ccolOledMax - 1;
+	}
+
+	if (colFirst < rgcolOledDirtyFirst[ipag]) {
+		rgcolOledDirtyFirst[ipag] = colFirst;
+	}
+	if (colLast > rgcolOledDirtyLast[ipag]) {
+		rgcolOledDirtyLast[ipag] = colLast;
+	}
+
 }
 
 /* ------------------------------------------------------------ */
@@ -379,42 +484,318 @@ OrbitOledClearBuffer()
 **		none
 **
 **	Description:
-**		Update the OLED display with the contents of the memory buffer
+**		Update the OLED display with the contents of the memory buffer,
+**		presenting and then flushing it. Waits for any flush still
+**		in progress first. With ORBITOLED_UDMA this only starts the
+**		transfer.
 */
 
 void
 OrbitOledUpdate()
 	{
+
+	while (!OrbitOledPresent());
+	OrbitOledFlush();
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledPresent
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		returns 1 if the changes were presented, 0 if a flush is
+**		still reading the front buffer
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Copy the parts of the back buffer changed since the last
+**		present into the front buffer, ready for OrbitOledFlush. If a
+**		flush is still in progress nothing is copied and the changes
+**		are kept for the next present, so this never waits.
+*/
+
+int
+OrbitOledPresent()
+	{
 	int		ipag;
-//	int		icol;
-	char *	pb;
+	int		ib;
+	int		ibLast;
 
-	pb = rgbOledBmp;
+	if (fOledFlushPending) {
+		return 0;
+	}
 
 	for (ipag = 0; ipag < cpagOledMax; ipag++) {
+		ib = ipag * ccolOledMax + rgcolOledDirtyFirst[ipag];
+		ibLast = ipag * ccolOledMax + rgcolOledDirtyLast[ipag];
+		for (; ib <= ibLast; ib++) {
+			rgbOledFront[ib] = rgbOledBmp[ib];
+		}
+
+		rgcolOledSendFirst[ipag] = rgcolOledDirtyFirst[ipag];
+		rgcolOledSendLast[ipag] = rgcolOledDirtyLast[ipag];
+		rgcolOledDirtyFirst[ipag] = ccolOledMax;
+		rgcolOledDirtyLast[ipag] = -1;
+	}
 
-		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
+	fOledFlushPending = 1;
+	return 1;
 
-		/* Set the page address
-		*/
-		Ssi3PutByte(0x22);		//Set page command
-		Ssi3PutByte(ipag);		//page number
+}
 
-		/* Start at the left column
-		*/
-		Ssi3PutByte(0x00);		//set low nibble of column
-		Ssi3PutByte(0x10);		//set high nibble of column
+/* ------------------------------------------------------------ */
+/***	OrbitOledFlush
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Send the presented changes in the front buffer to the
+**		display. Does nothing if nothing has been presented. With
+**		ORBITOLED_UDMA this only starts the transfer.
+*/
+
+void
+OrbitOledFlush()
+	{
+#if !defined(ORBITOLED_UDMA)
+	int		ipag;
+	int		colFirst;
+	int		colLast;
+#endif
+
+	if (!fOledFlushPending) {
+		return;
+	}
 
-		GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
+#if defined(ORBITOLED_UDMA)
+	ipagOledSend = 0;
+	OrbitOledSendNextPage();
+#else
+	for (ipag = 0; ipag < cpagOledMax; ipag++) {
 
-		/* Copy this memory page of display data.
+		colFirst = rgcolOledSendFirst[ipag];
+		colLast = rgcolOledSendLast[ipag];
+		if (colFirst > colLast) {
+			continue;
+		}
+
+		/* Copy the changed part of this memory page of display data.
 		*/
-		OrbitOledPutBuffer(ccolOledMax, pb);
-		pb += ccolOledMax;
+		OrbitOledSetPage(ipag, colFirst);
+		OrbitOledPutBuffer(colLast - colFirst + 1, &rgbOledFront[ipag * ccolOledMax + colFirst]);
+
+	}
+
+	fOledFlushPending = 0;
+	if (pfnOledUpdateDone != 0) {
+		(*pfnOledUpdateDone)();
+	}
+#endif
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledUpdateBusy
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		returns 1 while presented changes are still to be sent, else 0
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		The front buffer can't be presented to again until this
+**		returns 0.
+*/
+
+int
+OrbitOledUpdateBusy()
+	{
+
+	return fOledFlushPending;
 
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSetUpdateDone
+**
+**	Parameters:
+**		pfn		- function to call when an update is sent, or 0
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Set the function called once a flush has been sent to the
+**		display. With ORBITOLED_UDMA it is called from the SSI3
+**		interrupt, e.g. to wake the task waiting for the buffer.
+*/
+
+void
+OrbitOledSetUpdateDone(void (*pfn)(void))
+	{
+
+	pfnOledUpdateDone = pfn;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSetPage
+**
+**	Parameters:
+**		ipag	- page to write
+**		col		- first column to write
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Send the commands to address a page and column, leaving
+**		the Data/Cmd line selecting data.
+*/
+
+void
+OrbitOledSetPage(int ipag, int col)
+	{
+	char	rgbCmd[6];
+
+	/* Set the page address, as both the start and end page
+	** and as the page addressing mode page.
+	*/
+	rgbCmd[0] = 0x22;					//Set page command
+	rgbCmd[1] = ipag;					//start page
+	rgbCmd[2] = ipag;					//end page
+	rgbCmd[3] = 0xB0 | ipag;			//page number
+
+	/* Start at the given column
+	*/
+	rgbCmd[4] = 0x00 | (col & 0x0F);	//set low nibble of column
+	rgbCmd[5] = 0x10 | (col >> 4);		//set high nibble of column
+
+	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, LOW);
+	OrbitOledPutBuffer(sizeof(rgbCmd), rgbCmd);
+	GPIOPinWrite(nDC_OLEDPort, nDC_OLED, nDC_OLED);
+
+}
+
+#if defined(ORBITOLED_UDMA)
+/* ------------------------------------------------------------ */
+/***	OrbitOledSendNextPage
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Start the uDMA transfer of the next page with changes in
+**		the current flush, or finish the flush if there are none.
+*/
+
+void
+OrbitOledSendNextPage()
+	{
+	int		ipag;
+	int		colFirst;
+
+	for (ipag = ipagOledSend; ipag < cpagOledMax; ipag++) {
+		if (rgcolOledSendFirst[ipag] <= rgcolOledSendLast[ipag]) {
+			break;
+		}
+	}
+
+	if (ipag >= cpagOledMax) {
+		fOledFlushPending = 0;
+		if (pfnOledUpdateDone != 0) {
+			(*pfnOledUpdateDone)();
+		}
+		return;
+	}
+
+	ipagOledSend = ipag + 1;
+	colFirst = rgcolOledSendFirst[ipag];
+	OrbitOledSetPage(ipag, colFirst);
+
+	/* The slave select stays low until the SSI3 interrupt finds the
+	** transfer complete.
+	*/
+	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
+	uDMAChannelTransferSet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+						   &rgbOledFront[ipag * ccolOledMax + colFirst],
+						   (void *)(SSI3_BASE + SSI_O_DR),
+						   rgcolOledSendLast[ipag] - colFirst + 1);
+	uDMAChannelEnable(UDMA_CH15_SSI3TX);
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledSsiIntHandler
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		SSI3 interrupt. When the uDMA has written the last byte of a
+**		page to the FIFO, wait for it to shift out then start the
+**		next page.
+*/
+
+void
+OrbitOledSsiIntHandler()
+	{
+	uint32_t	bTmp;
+
+	SSIIntClear(SSI3_BASE, SSIIntStatus(SSI3_BASE, true));
+
+	if (!fOledFlushPending ||
+		uDMAChannelModeGet(UDMA_CH15_SSI3TX | UDMA_PRI_SELECT) != UDMA_MODE_STOP) {
+		return;
 	}
 
+	/* At most a FIFO's worth of bytes (8us) is left to send.
+	*/
+	while (SSIBusy(SSI3_BASE));
+	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, nCS_OLED);
+
+	/* Nobody reads the bytes received during the transfer.
+	*/
+	while (SSIDataGetNonBlocking(SSI3_BASE, &bTmp));
+
+	OrbitOledSendNextPage();
+
 }
+#endif
 
 /* ------------------------------------------------------------ */
 /***	OrbitOledPutBuffer
@@ -443,24 +824,21 @@ OrbitOledPutBuffer(int cb, char * rgbTx)
 	*/
 	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
 
-	/* Write/Read the data
+	/* Write the data. SSIDataPut only waits when the transmit FIFO
+	** is full, so the FIFO is kept topped up instead of waiting for
+	** each byte to shift out.
 	*/
 	for (ib = 0; ib < cb; ib++) {
-		/* Wait for transmitter to be ready
-		*/
-		while (SSIBusy(SSI3_BASE));
-
-		/* Write the next transmit byte.
-		*/
 		SSIDataPut(SSI3_BASE, (uint32_t)*rgbTx++);
-
-		/* Wait for receive byte.
-		*/
-		while (SSIBusy(SSI3_BASE));
-		SSIDataGet(SSI3_BASE, &bTmp);
-
 	}
 
+	/* Wait for the last byte to be sent, then discard the bytes
+	** received meanwhile (the receive FIFO just overflows on long
+	** transfers, nothing reads them).
+	*/
+	while (SSIBusy(SSI3_BASE));
+	while (SSIDataGetNonBlocking(SSI3_BASE, &bTmp));
+
 	/* Bring the slave select line high
 	*/
 	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, nCS_OLED);
@@ -492,9 +870,11 @@ Ssi3PutByte(char bVal)
 	*/
 	GPIOPinWrite(nCS_OLEDPort, nCS_OLED, LOW);
 
-	/* Wait for transmitter to be ready
+	/* Transfers always finish before returning, so the transmitter
+	** is idle. Discard anything left in the receive FIFO so the byte
+	** read back is the one for this transfer.
 	*/
-	while (SSIBusy(SSI3_BASE));
+	while (SSIDataGetNonBlocking(SSI3_BASE, &bRx));
 
 	/* Write the next transmit byte.
 	*/
@@ -42,6 +42,18 @@
 #define	modOledAnd		2
 #define	modOledXor		3
 
+/* Drawing goes into a back buffer. OrbitOledPresent copies the changes
+** to a front buffer and OrbitOledFlush sends them, so drawing can carry
+** on while a flush is in progress (e.g. in a lower priority task).
+** OrbitOledUpdate does both.
+**
+** Define ORBITOLED_UDMA (e.g. in the project's predefined symbols) to
+** send the page data to the display by uDMA. OrbitOledFlush then only
+** starts the transfer, and OrbitOledUpdateBusy returns 1 until it is
+** done. The application must set up the uDMA controller before
+** OrbitOledInit.
+*/
+
 /* ------------------------------------------------------------ */
 /*					General Type Declarations					*/
 /* ------------------------------------------------------------ */
@@ -66,6 +78,11 @@ void	OrbitOledInit();
 void	OrbitOledClear();
 void	OrbitOledClearBuffer();
 void	OrbitOledUpdate();
+void	OrbitOledMarkDirty(char * pb, int cb);
+int		OrbitOledPresent();
+void	OrbitOledFlush();
+int		OrbitOledUpdateBusy();
+void	OrbitOledSetUpdateDone(void (*pfn)(void));
 
 /* ------------------------------------------------------------ */
 
@@ -324,6 +324,8 @@ OrbitOledDrawGlyph(char ch)
 	char *	pbFont;
 	char *	pbBmp;
 	int		ib;
+	int		ibFirst;
+	int		ibLast;
 
 	if ((ch & 0x80) != 0) {
 		return;
@@ -338,8 +340,24 @@ OrbitOledDrawGlyph(char ch)
 
 	pbBmp = pbOledCur;
 
+	/* The cursor is always on a character cell, so the font bytes
+	** are copied straight into the display buffer. Only the bytes
+	** that change need to be sent on the next update.
+	*/
+	ibFirst = dxcoOledFontCur;
+	ibLast = -1;
 	for (ib = 0; ib < dxcoOledFontCur; ib++) {
-		*pbBmp++ = *pbFont++;
+		if (pbBmp[ib] != pbFont[ib]) {
+			pbBmp[ib] = pbFont[ib];
+			if (ibFirst > ib) {
+				ibFirst = ib;
+			}
+			ibLast = ib;
+		}
+	}
+
+	if (ibFirst <= ibLast) {
+		OrbitOledMarkDirty(pbBmp + ibFirst, ibLast - ibFirst + 1);
 	}
 
 }
@@ -0,0 +1,734 @@
+/************************************************************************/
+/*																		*/
+/*	OrbitOledEmu.c	--	OLED Display Emulator for Host Builds			*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Only compiled with HOST_BUILD defined, and then linked in place		*/
+/*	of driverlib. It implements the SSI3, GPIO, SysCtl and Timer		*/
+/*	calls used by OrbitOled.c and delay.c. Bytes written to SSI3		*/
+/*	while the slave select is low go to an emulated SSD1306, as			*/
+/*	commands or as display RAM data depending on the Data/Cmd pin,		*/
+/*	so the image the display would show can be read back, compared		*/
+/*	with the driver's buffer and captured.								*/
+/*																		*/
+/*	Built by host/Makefile, see host/oledRegress.c.						*/
+/*																		*/
+/************************************************************************/
+
+#if defined(HOST_BUILD)
+
+#if defined(ORBITOLED_UDMA)
+#error "The OLED emulator only covers the SSI FIFO path, not ORBITOLED_UDMA"
+#endif
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <stdio.h>
+
+#include "LaunchPad.h"
+#include "OrbitBoosterPackDefs.h"
+#include "OrbitOled.h"
+#include "OrbitOledEmu.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+
+#define	modOledEmuHorz	0		//horizontal addressing mode
+#define	modOledEmuVert	1		//vertical addressing mode
+#define	modOledEmuPage	2		//page addressing mode (reset default)
+
+#define	cbOledEmuArgMax	6		//most argument bytes taken by a command
+#define	cbOledEmuRxMax	8		//SSI receive FIFO depth
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+
+/* Emulated controller display RAM, one byte per column per page
+** with the least significant bit at the top, as in rgbOledBmp.
+*/
+unsigned char	rgbOledEmuRam[cpagOledEmuMax * ccolOledMax];
+
+int		modOledEmuAddr;
+int		colOledEmuStart;
+int		colOledEmuEnd;
+int		pagOledEmuStart;
+int		pagOledEmuEnd;
+int		colOledEmuCur;
+int		pagOledEmuCur;
+int		fOledEmuOn;
+
+/* Command being collected, and how many argument bytes it still
+** needs.
+*/
+unsigned char	bOledEmuCmd;
+unsigned char	rgbOledEmuArg[cbOledEmuArgMax];
+int		cbOledEmuArg;
+int		cbOledEmuArgNeed;
+
+/* Pin states, set by GPIOPinWrite.
+*/
+int		fOledEmuData;
+int		fOledEmuSelect;
+int		fOledEmuReset;
+
+unsigned long	cbOledEmuCmd;
+unsigned long	cbOledEmuData;
+unsigned long	ifrmOledEmu;
+int		cbOledEmuRx;
+
+/* ------------------------------------------------------------ */
+/*				Forward Declarations							*/
+/* ------------------------------------------------------------ */
+
+void	OrbitOledEmuCommand(unsigned char b);
+void	OrbitOledEmuWriteData(unsigned char b);
+void	OrbitOledEmuPutLong(unsigned long ul, FILE * fp);
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuReset
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Put the emulated controller in its reset state, as when the
+**		reset pin is brought low. The display RAM is not changed.
+*/
+
+void
+OrbitOledEmuReset()
+	{
+
+	modOledEmuAddr = modOledEmuPage;
+	colOledEmuStart = 0;
+	colOledEmuEnd = ccolOledMax - 1;
+	pagOledEmuStart = 0;
+	pagOledEmuEnd = cpagOledEmuMax - 1;
+	colOledEmuCur = 0;
+	pagOledEmuCur = 0;
+	fOledEmuOn = 0;
+	cbOledEmuArgNeed = 0;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuGetPixel
+**
+**	Parameters:
+**		xco		- x coordinate
+**		yco		- y coordinate
+**
+**	Return Value:
+**		returns 1 if the pixel is lit, else 0
+**
+**	Errors:
+**		returns 0 for coordinates off the display
+**
+**	Description:
+**		Return a pixel of the image the display is showing. All
+**		pixels are off while the display is turned off.
+*/
+
+int
+OrbitOledEmuGetPixel(int xco, int yco)
+	{
+
+	if (!fOledEmuOn || xco < 0 || xco >= ccolOledMax || yco < 0 || yco >= crowOledMax) {
+		return 0;
+	}
+
+	return (rgbOledEmuRam[(yco / 8) * ccolOledMax + xco] >> (yco & 0x07)) & 0x01;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuCompare
+**
+**	Parameters:
+**		pbBuf	- display buffer to compare with (cbOledDispMax bytes)
+**
+**	Return Value:
+**		returns the number of bytes that differ
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Compare the emulated display RAM with a display buffer,
+**		e.g. rgbOledBmp after OrbitOledUpdate, to check that only
+**		sending the dirty parts kept the display in step.
+*/
+
+int
+OrbitOledEmuCompare(char * pbBuf)
+	{
+	int		ib;
+	int		cbDiff;
+
+	cbDiff = 0;
+	for (ib = 0; ib < cbOledDispMax; ib++) {
+		if (rgbOledEmuRam[ib] != (unsigned char)pbBuf[ib]) {
+			cbDiff += 1;
+		}
+	}
+
+	return cbDiff;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuGetCounts
+**
+**	Parameters:
+**		pcbCmd	- variable to receive the command bytes sent
+**		pcbData	- variable to receive the data bytes sent
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Return the number of bytes the controller has received
+**		since it was first written to.
+*/
+
+void
+OrbitOledEmuGetCounts(unsigned long * pcbCmd, unsigned long * pcbData)
+	{
+
+	*pcbCmd = cbOledEmuCmd;
+	*pcbData = cbOledEmuData;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuSendUs
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		returns the SSI time taken by all the bytes sent, in us
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		The time the bytes sent so far would have taken on the
+**		SSI3 bus, for display throughput measurements.
+*/
+
+unsigned long
+OrbitOledEmuSendUs()
+	{
+
+	return (unsigned long)(((unsigned long long)(cbOledEmuCmd + cbOledEmuData) * 8 * 1000000) / bpsOledEmuSsi);
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuWritePbm
+**
+**	Parameters:
+**		szFile	- name of the file to write
+**
+**	Return Value:
+**		returns 1 if the file was written, else 0
+**
+**	Errors:
+**		returns 0 if the file can't be written
+**
+**	Description:
+**		Write the image the display is showing as a binary PBM
+**		file, lit pixels white as on the display.
+*/
+
+int
+OrbitOledEmuWritePbm(const char * szFile)
+	{
+	FILE *	fp;
+	int		xco;
+	int		yco;
+	int		bRow;
+	int		fOk;
+
+	fp = fopen(szFile, "wb");
+	if (fp == NULL) {
+		return 0;
+	}
+
+	fprintf(fp, "P4\n%d %d\n", ccolOledMax, crowOledMax);
+	for (yco = 0; yco < crowOledMax; yco++) {
+		bRow = 0;
+		for (xco = 0; xco < ccolOledMax; xco++) {
+			/* PBM bits are 1 for black.
+			*/
+			bRow = (bRow << 1) | (OrbitOledEmuGetPixel(xco, yco) ^ 0x01);
+			if ((xco & 0x07) == 0x07) {
+				fputc(bRow, fp);
+				bRow = 0;
+			}
+		}
+	}
+
+	fOk = !ferror(fp);
+	if (fclose(fp) != 0) {
+		fOk = 0;
+	}
+	return fOk;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuLogFrame
+**
+**	Parameters:
+**		fp		- file to append the frame to
+**
+**	Return Value:
+**		returns 1 if the frame was written, else 0
+**
+**	Errors:
+**		returns 0 on a write error
+**
+**	Description:
+**		Append a frame record to a frame log: the frame number,
+**		display on flag, command and data bytes received so far
+**		(each 32 bit little endian) then the cbOledDispMax bytes of
+**		display RAM in rgbOledBmp layout. Call it after each update,
+**		e.g. from the OrbitOledSetUpdateDone callback.
+*/
+
+int
+OrbitOledEmuLogFrame(FILE * fp)
+	{
+
+	OrbitOledEmuPutLong(ifrmOledEmu, fp);
+	OrbitOledEmuPutLong(fOledEmuOn, fp);
+	OrbitOledEmuPutLong(cbOledEmuCmd, fp);
+	OrbitOledEmuPutLong(cbOledEmuData, fp);
+	fwrite(rgbOledEmuRam, 1, cbOledDispMax, fp);
+	ifrmOledEmu += 1;
+
+	return !ferror(fp);
+
+}
+
+/* ------------------------------------------------------------ */
+/*				Emulated driverlib Routines						*/
+/* ------------------------------------------------------------ */
+/***	GPIOPinWrite
+**
+**	Parameters:
+**		ui32Port	- GPIO port base address
+**		ui8Pins		- pins to write
+**		ui8Val		- pin values
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Track the display's Data/Cmd, slave select and reset pins.
+**		Bringing reset low resets the controller.
+*/
+
+void
+GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+	{
+
+	if (ui32Port == nDC_OLEDPort && (ui8Pins & nDC_OLED) != 0) {
+		fOledEmuData = (ui8Val & nDC_OLED) != 0;
+	}
+	if (ui32Port == nCS_OLEDPort && (ui8Pins & nCS_OLED) != 0) {
+		fOledEmuSelect = (ui8Val & nCS_OLED) == 0;
+	}
+	if (ui32Port == nRES_OLEDPort && (ui8Pins & nRES_OLED) != 0) {
+		if ((ui8Val & nRES_OLED) == 0 && !fOledEmuReset) {
+			OrbitOledEmuReset();
+		}
+		fOledEmuReset = (ui8Val & nRES_OLED) == 0;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	SSIDataPut
+**
+**	Parameters:
+**		ui32Base	- SSI base address
+**		ui32Data	- byte to send
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Send a byte to the emulated controller. The transfer
+**		completes at once, and a byte is received for it.
+*/
+
+void
+SSIDataPut(uint32_t ui32Base, uint32_t ui32Data)
+	{
+
+	if (cbOledEmuRx < cbOledEmuRxMax) {
+		cbOledEmuRx += 1;
+	}
+
+	if (ui32Base != SSI3_BASE || !fOledEmuSelect || fOledEmuReset) {
+		return;
+	}
+
+	if (fOledEmuData) {
+		cbOledEmuData += 1;
+		OrbitOledEmuWriteData((unsigned char)ui32Data);
+	}
+	else {
+		cbOledEmuCmd += 1;
+		OrbitOledEmuCommand((unsigned char)ui32Data);
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	SSIDataGetNonBlocking
+**
+**	Parameters:
+**		ui32Base	- SSI base address
+**		pui32Data	- variable to receive the byte
+**
+**	Return Value:
+**		returns 1 if a byte was received, else 0
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Read a byte from the receive FIFO. The display never
+**		drives the receive line, so the bytes are 0.
+*/
+
+int32_t
+SSIDataGetNonBlocking(uint32_t ui32Base, uint32_t * pui32Data)
+	{
+
+	if (cbOledEmuRx == 0) {
+		return 0;
+	}
+
+	cbOledEmuRx -= 1;
+	*pui32Data = 0;
+	return 1;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	SSIDataGet
+**
+**	Parameters:
+**		ui32Base	- SSI base address
+**		pui32Data	- variable to receive the byte
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Read a byte from the receive FIFO. Returns 0 rather than
+**		waiting forever if nothing has been sent.
+*/
+
+void
+SSIDataGet(uint32_t ui32Base, uint32_t * pui32Data)
+	{
+
+	if (!SSIDataGetNonBlocking(ui32Base, pui32Data)) {
+		*pui32Data = 0;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	SSIBusy
+**
+**	Description:
+**		Transfers complete as soon as they are written.
+*/
+
+bool
+SSIBusy(uint32_t ui32Base)
+	{
+
+	return false;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	SysCtlClockGet
+**
+**	Description:
+**		Return the 80MHz system clock the target runs at.
+*/
+
+uint32_t
+SysCtlClockGet()
+	{
+
+	return 80000000;
+
+}
+
+/* ------------------------------------------------------------ */
+/***	TimerValueGet
+**
+**	Description:
+**		Return a count past any delay, so DelayMs never waits.
+*/
+
+uint32_t
+TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+	{
+
+	return 0xFFFFFFFF;
+
+}
+
+/* ------------------------------------------------------------ */
+/*		Peripheral set up calls, with nothing to emulate		*/
+/* ------------------------------------------------------------ */
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+	{
+}
+
+void
+GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+	{
+}
+
+void
+GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins)
+	{
+}
+
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+	{
+}
+
+void
+SSIClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+	{
+}
+
+void
+SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk, uint32_t ui32Protocol,
+				   uint32_t ui32Mode, uint32_t ui32BitRate, uint32_t ui32DataWidth)
+	{
+}
+
+void
+SSIEnable(uint32_t ui32Base)
+	{
+}
+
+void
+TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+	{
+}
+
+void
+TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+	{
+}
+
+/* ------------------------------------------------------------ */
+/*				Internal Support Routines						*/
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuCommand
+**
+**	Parameters:
+**		b		- command byte received
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Decode a command byte. Commands that take arguments are
+**		collected until all their bytes have arrived. Commands that
+**		don't affect the image (contrast, charge pump, scrolling,
+**		etc.) are accepted and ignored.
+*/
+
+void
+OrbitOledEmuCommand(unsigned char b)
+	{
+
+	if (cbOledEmuArgNeed > 0) {
+		rgbOledEmuArg[cbOledEmuArg++] = b;
+		cbOledEmuArgNeed -= 1;
+		if (cbOledEmuArgNeed > 0) {
+			return;
+		}
+
+		switch (bOledEmuCmd) {
+			case 0x20:				//memory addressing mode
+				if ((rgbOledEmuArg[0] & 0x03) != 0x03) {
+					modOledEmuAddr = rgbOledEmuArg[0] & 0x03;
+				}
+				break;
+
+			case 0x21:				//column address range
+				colOledEmuStart = rgbOledEmuArg[0] & 0x7F;
+				colOledEmuEnd = rgbOledEmuArg[1] & 0x7F;
+				colOledEmuCur = colOledEmuStart;
+				break;
+
+			case 0x22:				//page address range
+				pagOledEmuStart = rgbOledEmuArg[0] & 0x07;
+				pagOledEmuEnd = rgbOledEmuArg[1] & 0x07;
+				pagOledEmuCur = pagOledEmuStart;
+				break;
+		}
+		return;
+	}
+
+	bOledEmuCmd = b;
+	cbOledEmuArg = 0;
+
+	if (b <= 0x0F) {
+		colOledEmuCur = (colOledEmuCur & 0xF0) | b;
+	}
+	else if (b <= 0x1F) {
+		colOledEmuCur = ((b & 0x07) << 4) | (colOledEmuCur & 0x0F);
+	}
+	else if (b >= 0xB0 && b <= 0xB7) {
+		pagOledEmuCur = b & 0x07;
+	}
+	else if (b == 0xAE || b == 0xAF) {
+		fOledEmuOn = b & 0x01;
+	}
+	else if (b == 0x26 || b == 0x27) {
+		cbOledEmuArgNeed = 6;
+	}
+	else if (b == 0x29 || b == 0x2A) {
+		cbOledEmuArgNeed = 5;
+	}
+	else if (b == 0x21 || b == 0x22 || b == 0xA3) {
+		cbOledEmuArgNeed = 2;
+	}
+	else if (b == 0x20 || b == 0x81 || b == 0x8D || b == 0xA8 || b == 0xD3 ||
+			 b == 0xD5 || b == 0xD9 || b == 0xDA || b == 0xDB) {
+		cbOledEmuArgNeed = 1;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuWriteData
+**
+**	Parameters:
+**		b		- display data byte received
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Write a byte to the display RAM and advance the address
+**		according to the addressing mode.
+*/
+
+void
+OrbitOledEmuWriteData(unsigned char b)
+	{
+
+	rgbOledEmuRam[pagOledEmuCur * ccolOledMax + colOledEmuCur] = b;
+
+	if (modOledEmuAddr == modOledEmuPage) {
+		/* The page doesn't change, the column wraps around.
+		*/
+		colOledEmuCur = (colOledEmuCur + 1) & (ccolOledMax - 1);
+	}
+	else if (modOledEmuAddr == modOledEmuHorz) {
+		if (colOledEmuCur < colOledEmuEnd) {
+			colOledEmuCur += 1;
+		}
+		else {
+			colOledEmuCur = colOledEmuStart;
+			pagOledEmuCur = (pagOledEmuCur < pagOledEmuEnd) ? pagOledEmuCur + 1 : pagOledEmuStart;
+		}
+	}
+	else {
+		if (pagOledEmuCur < pagOledEmuEnd) {
+			pagOledEmuCur += 1;
+		}
+		else {
+			pagOledEmuCur = pagOledEmuStart;
+			colOledEmuCur = (colOledEmuCur < colOledEmuEnd) ? colOledEmuCur + 1 : colOledEmuStart;
+		}
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/***	OrbitOledEmuPutLong
+**
+**	Parameters:
+**		ul		- value to write
+**		fp		- file to write to
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Write the low 32 bits of a value, least significant byte
+**		first.
+*/
+
+void
+OrbitOledEmuPutLong(unsigned long ul, FILE * fp)
+	{
+	int		ib;
+
+	for (ib = 0; ib < 4; ib++) {
+		fputc((int)((ul >> (8 * ib)) & 0xFF), fp);
+	}
+
+}
+
+#endif
+
+/************************************************************************/
@@ -0,0 +1,43 @@
+/************************************************************************/
+/*																		*/
+/*	OrbitOledEmu.h	--	Interface Declarations for the OLED Emulator	*/
+/*																		*/
+/************************************************************************/
+/*  File Description:													*/
+/*																		*/
+/*	Host build (HOST_BUILD) replacement for the SSI3 and GPIO calls		*/
+/*	made by the OLED driver. The bytes sent are decoded by an			*/
+/*	emulated SSD1306 controller so the display image can be checked		*/
+/*	and captured without the hardware.									*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ORBITOLEDEMU_INC)
+#define	ORBITOLEDEMU_INC
+
+#include <stdio.h>
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	cpagOledEmuMax	8		//display RAM pages in the controller
+#define	bpsOledEmuSsi	8000000	//SSI3 bit rate set by OrbitOledHostInit
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	OrbitOledEmuReset();
+int		OrbitOledEmuGetPixel(int xco, int yco);
+int		OrbitOledEmuCompare(char * pbBuf);
+void	OrbitOledEmuGetCounts(unsigned long * pcbCmd, unsigned long * pcbData);
+unsigned long	OrbitOledEmuSendUs();
+int		OrbitOledEmuWritePbm(const char * szFile);
+int		OrbitOledEmuLogFrame(FILE * fp);
+
+/* ------------------------------------------------------------ */
+
+#endif
+
+/************************************************************************/
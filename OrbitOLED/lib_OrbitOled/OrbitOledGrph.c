@@ -23,6 +23,9 @@
 /*				Include File Definitions						*/
 /* ------------------------------------------------------------ */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "FillPat.h"
 #include "LaunchPad.h"
 #include "OrbitBoosterPackDefs.h"
@@ -69,6 +72,7 @@ char	OrbitOledRopSet(char bPix, char bDsp, char mskPix);
 char	OrbitOledRopOr(char bPix, char bDsp, char mskPix);
 char	OrbitOledRopAnd(char bPix, char bDsp, char mskPix);
 char	OrbitOledRopXor(char bPix, char bDsp, char mskPix);
+void	OrbitOledRopSpan(char * pb, int cb, char bPix, char mskPix);
 int		OrbitOledClampXco(int xco);
 int		OrbitOledClampYco(int yco);
 
@@ -303,8 +307,13 @@ OrbitOledGetDrawMode()
 void
 OrbitOledDrawPixel()
 	{
+	char	bNew;
 
-	*pbOledCur = (*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur));
+	bNew = (*pfnDoRop)((clrOledCur << bnOledCur), *pbOledCur, (1<<bnOledCur));
+	if (bNew != *pbOledCur) {
+		*pbOledCur = bNew;
+		OrbitOledMarkDirty(pbOledCur, 1);
+	}
 
 }
 
@@ -347,7 +356,8 @@ OrbitOledGetPixel()
 **
 **	Description:
 **		Draw a line from the current position to the specified
-**		position.
+**		position. Horizontal and vertical lines are drawn a byte
+**		at a time rather than a pixel at a time.
 */
 
 void
@@ -361,16 +371,56 @@ OrbitOledLineTo(int xco, int yco)
 	int		dyco;
 	void	(*pfnMajor)();
 	void	(*pfnMinor)();
+	int		xcoLeft;
+	int		ycoTop;
+	int		ycoBottom;
+	int		ycoEnd;
+	char	mskPix;
 
 	/* Clamp the point to be on the display.
 	*/
 	xco = OrbitOledClampXco(xco);
 	yco = OrbitOledClampYco(yco);
 
-	/* Determine which octant the line occupies
-	*/
 	dxco = xco - xcoOledCur;
 	dyco = yco - ycoOledCur;
+
+	/* As with the general case below, the line includes the current
+	** position but not the end point. The And raster op clears the
+	** rest of the byte for each pixel, so several pixels of one byte
+	** can't be drawn together in that mode.
+	*/
+	if ((dyco == 0) && (dxco != 0) && (modOledCur != modOledAnd)) {
+		/* Horizontal line, the same bit in a run of bytes in one page.
+		*/
+		xcoLeft = (dxco > 0) ? xcoOledCur : xco + 1;
+		OrbitOledRopSpan(&rgbOledBmp[((ycoOledCur/8) * ccolOledMax) + xcoLeft],
+						 abs(dxco), (clrOledCur << bnOledCur), (1 << bnOledCur));
+		OrbitOledMoveTo(xco, yco);
+		return;
+	}
+
+	if ((dxco == 0) && (dyco != 0) && (modOledCur != modOledAnd)) {
+		/* Vertical line, a run of bits in the same column of each page.
+		*/
+		ycoTop = (dyco > 0) ? ycoOledCur : yco + 1;
+		ycoBottom = (dyco > 0) ? yco - 1 : ycoOledCur;
+		while (ycoTop <= ycoBottom) {
+			ycoEnd = ycoTop | 0x07;
+			if (ycoEnd > ycoBottom) {
+				ycoEnd = ycoBottom;
+			}
+			mskPix = (0xFF << (ycoTop & 0x07)) & (0xFF >> (7 - (ycoEnd & 0x07)));
+			OrbitOledRopSpan(&rgbOledBmp[((ycoTop/8) * ccolOledMax) + xco],
+							 1, (clrOledCur != 0) ? 0xFF : 0x00, mskPix);
+			ycoTop = ycoEnd + 1;
+		}
+		OrbitOledMoveTo(xco, yco);
+		return;
+	}
+
+	/* Determine which octant the line occupies
+	*/
 	if (abs(dxco) >= abs(dyco)) {
 		/* Line is x-major
 		*/
@@ -490,7 +540,8 @@ OrbitOledDrawRect(int xco, int yco)
 **
 **	Description:
 **		Fill a rectangle bounded by the current location and
-**		the specified location.
+**		the specified location. With a solid fill pattern each
+**		stripe is filled a run of bytes at a time.
 */
 
 void
@@ -505,12 +556,23 @@ OrbitOledFillRect(int xco, int yco)
 	char *	pbLeft;
 	int		xcoCur;
 	char	mskPat;
+	int		fPatSolid;
 
 	/* Clamp the point to be on the display.
 	*/
 	xco = OrbitOledClampXco(xco);
 	yco = OrbitOledClampYco(yco);
 
+	/* A pattern with every column the same (e.g. the solid black and
+	** white patterns) doesn't need stepping through column by column.
+	*/
+	fPatSolid = 1;
+	for (ibPat = 1; ibPat < 8; ibPat++) {
+		if (pbOledPatCur[ibPat] != pbOledPatCur[0]) {
+			fPatSolid = 0;
+		}
+	}
+
 	/* Set up the four sides of the rectangle.
 	*/
 	if (xcoOledCur < xco) {
@@ -558,13 +620,19 @@ OrbitOledFillRect(int xco, int yco)
 		/* Loop through all of the bytes horizontally making up this stripe
 		** of the rectangle.
 		*/
-		while (xcoCur <= xcoRight) {
-			*pbCur = (*pfnDoRop)(*(pbOledPatCur+ibPat), *pbCur, ~mskPat);
-			xcoCur += 1;
-			pbCur += 1;
-			ibPat += 1;
-			if (ibPat > 7) {
-				ibPat = 0;
+		if (fPatSolid) {
+			OrbitOledRopSpan(pbLeft, xcoRight - xcoLeft + 1, *pbOledPatCur, ~mskPat);
+		}
+		else {
+			OrbitOledMarkDirty(pbLeft, xcoRight - xcoLeft + 1);
+			while (xcoCur <= xcoRight) {
+				*pbCur = (*pfnDoRop)(*(pbOledPatCur+ibPat), *pbCur, ~mskPat);
+				xcoCur += 1;
+				pbCur += 1;
+				ibPat += 1;
+				if (ibPat > 7) {
+					ibPat = 0;
+				}
 			}
 		}
 
@@ -618,14 +686,14 @@ OrbitOledGetBmp(int dxco, int dyco, char * pbBits)
 	*/
 	xcoLeft = xcoOledCur;
 	xcoRight = xcoLeft + dxco;
-	if (xcoRight >= ccolOledMax) {
-		xcoRight = ccolOledMax - 1;
+	if (xcoRight > ccolOledMax) {
+		xcoRight = ccolOledMax;
 	}
 
 	ycoTop = ycoOledCur;
 	ycoBottom = ycoTop + dyco;
-	if (ycoBottom >= crowOledMax) {
-		ycoBottom = crowOledMax - 1;
+	if (ycoBottom > crowOledMax) {
+		ycoBottom = crowOledMax;
 	}
 
 	bnAlign = ycoTop & 0x07;
@@ -695,7 +763,9 @@ OrbitOledGetBmp(int dxco, int dyco, char * pbBits)
 **
 **	Description:
 **		This routine will put the specified bitmap into the display
-**		buffer at the current location.
+**		buffer at the current location. Whole bytes being set (e.g.
+**		a character drawn in a character cell) are copied directly
+**		rather than through the raster op.
 */
 
 void
@@ -707,6 +777,10 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 	int		ycoBottom;
 	char *	pbDspCur;
 	char *	pbDspLeft;
+#if !defined(ORBITOLED_NO_FAST_BMP)
+	char *	pbDspFirst;
+	char *	pbDspLast;
+#endif
 	char *	pbBmpCur;
 	char *	pbBmpLeft;
 	int		xcoCur;
@@ -721,14 +795,14 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 	*/
 	xcoLeft = xcoOledCur;
 	xcoRight = xcoLeft + dxco;
-	if (xcoRight >= ccolOledMax) {
-		xcoRight = ccolOledMax - 1;
+	if (xcoRight > ccolOledMax) {
+		xcoRight = ccolOledMax;
 	}
 
 	ycoTop = ycoOledCur;
 	ycoBottom = ycoTop + dyco;
-	if (ycoBottom >= crowOledMax) {
-		ycoBottom = crowOledMax - 1;
+	if (ycoBottom > crowOledMax) {
+		ycoBottom = crowOledMax;
 	}
 
 	bnAlign = ycoTop & 0x07;
@@ -761,7 +835,37 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 		/* Loop through all of the bytes horizontally making up this stripe
 		** of the rectangle.
 		*/
+#if !defined(ORBITOLED_NO_FAST_BMP)
+		if ((bnAlign == 0) && (mskEnd == (char)0xFF) && (modOledCur == modOledSet)) {
+			/* The stripe replaces whole display bytes, so copy it, only
+			** marking the span of bytes that change. Defining
+			** ORBITOLED_NO_FAST_BMP sends these through the raster op too
+			** (host/oledBench.c).
+			*/
+			pbDspFirst = NULL;
+			pbDspLast = NULL;
+			while (xcoCur < xcoRight) {
+				if (*pbDspCur != *pbBmpCur) {
+					*pbDspCur = *pbBmpCur;
+					if (pbDspFirst == NULL) {
+						pbDspFirst = pbDspCur;
+					}
+					pbDspLast = pbDspCur;
+				}
+				xcoCur += 1;
+				pbDspCur += 1;
+				pbBmpCur += 1;
+			}
+			if (pbDspFirst != NULL) {
+				OrbitOledMarkDirty(pbDspFirst, pbDspLast - pbDspFirst + 1);
+			}
+		}
+		else
+#endif
 		if (bnAlign == 0) {
+			if (xcoRight > xcoLeft) {
+				OrbitOledMarkDirty(pbDspLeft, xcoRight - xcoLeft);
+			}
 			while (xcoCur < xcoRight) {
 				*pbDspCur = (*pfnDoRop)(*pbBmpCur, *pbDspCur, mskEnd);
 				xcoCur += 1;
@@ -770,6 +874,9 @@ OrbitOledPutBmp(int dxco, int dyco, char * pbBits)
 			}
 		}
 		else {
+			if (xcoRight > xcoLeft) {
+				OrbitOledMarkDirty(pbDspLeft, xcoRight - xcoLeft);
+			}
 			while (xcoCur < xcoRight) {
 				bBmp = ((*pbBmpCur) << bnAlign);
 				if (!fTop) {
@@ -863,6 +970,55 @@ OrbitOledDrawString(char * sz)
 	}
 }
 
+/* ------------------------------------------------------------ */
+/***	OrbitOledScrollLeft
+**
+**	Parameters:
+**		ipagFirst	- first display page to scroll
+**		ipagLast	- last display page to scroll
+**		dxco		- number of columns to scroll by
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Move the contents of the specified pages of the display
+**		buffer left, clearing the columns uncovered at the right
+**		edge. Scrolling by the display width clears the pages.
+**		The current drawing position is not changed.
+*/
+
+void
+OrbitOledScrollLeft(int ipagFirst, int ipagLast, int dxco)
+	{
+	int		ipag;
+	char *	pbPage;
+
+	if (ipagFirst < 0) {
+		ipagFirst = 0;
+	}
+	if (ipagLast >= cpagOledMax) {
+		ipagLast = cpagOledMax - 1;
+	}
+	if (dxco > ccolOledMax) {
+		dxco = ccolOledMax;
+	}
+	if (dxco <= 0) {
+		return;
+	}
+
+	for (ipag = ipagFirst; ipag <= ipagLast; ipag++) {
+		pbPage = &rgbOledBmp[ipag * ccolOledMax];
+		memmove(pbPage, pbPage + dxco, ccolOledMax - dxco);
+		memset(pbPage + ccolOledMax - dxco, 0, dxco);
+		OrbitOledMarkDirty(pbPage, ccolOledMax);
+	}
+
+}
+
 /* ------------------------------------------------------------ */
 /*				Internal Support Routines						*/
 /* ------------------------------------------------------------ */
@@ -949,6 +1105,76 @@ OrbitOledRopXor(char bPix, char bDsp, char mskPix)
 
 }
 
+/* ------------------------------------------------------------ */
+/***	OrbitOledRopSpan
+**
+**	Parameters:
+**		pb			- pointer to the first display byte
+**		cb			- number of display bytes
+**		bPix		- pixel bits to combine into each byte
+**		mskPix		- mask of the bits in each byte being drawn
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Combine the same pixel bits into a run of display bytes
+**		using the current drawing mode, marking only the part of
+**		the run that changes. Setting whole bytes is done with
+**		memset.
+*/
+
+void
+OrbitOledRopSpan(char * pb, int cb, char bPix, char mskPix)
+	{
+	int		ib;
+	int		ibFirst;
+	int		ibLast;
+	char	bNew;
+
+	ibFirst = cb;
+	ibLast = -1;
+
+	if ((modOledCur == modOledSet) && (mskPix == (char)0xFF)) {
+		for (ib = 0; ib < cb; ib++) {
+			if (pb[ib] != bPix) {
+				if (ibFirst > ib) {
+					ibFirst = ib;
+				}
+				ibLast = ib;
+			}
+		}
+		if (ibFirst <= ibLast) {
+			memset(pb + ibFirst, bPix, ibLast - ibFirst + 1);
+		}
+	}
+	else {
+		for (ib = 0; ib < cb; ib++) {
+			if (modOledCur == modOledSet) {
+				bNew = (pb[ib] & ~mskPix) | (bPix & mskPix);
+			}
+			else {
+				bNew = (*pfnDoRop)(bPix, pb[ib], mskPix);
+			}
+			if (pb[ib] != bNew) {
+				pb[ib] = bNew;
+				if (ibFirst > ib) {
+					ibFirst = ib;
+				}
+				ibLast = ib;
+			}
+		}
+	}
+
+	if (ibFirst <= ibLast) {
+		OrbitOledMarkDirty(pb + ibFirst, ibLast - ibFirst + 1);
+	}
+
+}
+
 /* ------------------------------------------------------------ */
 /***	OrbitOledMoveUp
 **
@@ -62,6 +62,7 @@ void	OrbitOledGetBmp(int dxco, int dyco, char * pbBmp);
 void	OrbitOledPutBmp(int dxco, int dyco, char * pbBmp);
 void	OrbitOledDrawChar(char ch);
 void	OrbitOledDrawString(char * sz);
+void	OrbitOledScrollLeft(int ipagFirst, int ipagLast, int dxco);
 
 /* ------------------------------------------------------------ */
 
@@ -105,7 +105,9 @@ DelayMs(int cms)
 		/*
 		 * Clear Timer1
 		 */
+#if !defined(HOST_BUILD)
 		HWREG(TIMER1_BASE + TIMER_O_TAV) = 0;
+#endif
 		while (TimerValueGet(TIMER1_BASE, TIMER_A) < cntMsDelay);
 	}
 
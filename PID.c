@@ -6,16 +6,33 @@
  * T3 Project Group 6 2021
  */
 
+#include <stddef.h>
+
 #include "pid.h"
 
 uint32_t pid(float input, float setpoint, float period, pid_struct *pidObj) {
+    return pidFeedforward(input, setpoint, 0, period, pidObj);
+}
+
+uint32_t pidFeedforward(float input, float setpoint, float feedforward, float period, pid_struct *pidObj) {
     float error = setpoint - input;
-    float P = pidObj->Kp * error;
-    float dI = pidObj->Ki * error * period;
-    float D = (pidObj->Kd/period)*(error - pidObj->prev_error);
+    float Kp = pidObj->Kp;
+    float Ki = pidObj->Ki;
+    float Kd = pidObj->Kd;
+
+    if (pidObj->scale != NULL) {
+        Kp *= pidObj->scale->Kp;
+        Ki *= pidObj->scale->Ki;
+        Kd *= pidObj->scale->Kd;
+    }
+
+    float P = Kp * error;
+    float dI = Ki * error * period;
+    float D = (Kd/period)*(error - pidObj->prev_error);
 
     pidObj->prev_error = error;
-    uint32_t control = P + pidObj->I + D;
+    // Clamp in float, a negative command must not be converted to an unsigned value first
+    float control = P + pidObj->I + D + feedforward;
 
 // Clamp values for control to range 2 - 98% for PWM
     if (control > pidObj->output_max){
@@ -25,5 +42,5 @@ uint32_t pid(float input, float setpoint, float period, pid_struct *pidObj) {
     } else {
         pidObj->I += dI;
     }
-    return control;
+    return (uint32_t)control;
 }
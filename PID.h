@@ -11,6 +11,21 @@
 
 #include <stdint.h>
 
+/**
+ * @struct              pid_gain_scale.
+ * @brief               Multipliers applied to a PID structure's gains, e.g. from a gain schedule table.
+ *
+ * @param Kp            Proportional gain multiplier.
+ * @param Ki            Integral gain multiplier.
+ * @param Kd            Derivative gain multiplier.
+*/
+typedef struct _pid_gain_scale{
+    float Kp;
+    float Ki;
+    float Kd;
+} pid_gain_scale;
+
+
 /**
  * @struct              pid_struct.
  * @brief               Contains all PID object's properties.
@@ -23,6 +38,7 @@
  * @param I             Integral 
  * @param output_min    Minimum output value (limits minimum motor duty cycle)
  * @param output_max    Maximum output value (limits maximum motor duty cycle)
+ * @param scale         Gain multipliers to apply (NULL to use the gains unscaled)
 */
 typedef struct _pid_struct{
     float Kp;
@@ -32,6 +48,7 @@ typedef struct _pid_struct{
     float I;
     const uint8_t output_min;
     const uint8_t output_max;
+    const pid_gain_scale *scale;
 } pid_struct;
 
 
@@ -46,4 +63,18 @@ typedef struct _pid_struct{
 */
 uint32_t pid(float input, float setpoint, float period, pid_struct *pidObj);
 
+
+/**
+ * @function            pidFeedforward
+ * @brief               Calculate and output command for given PID structure with a feedforward term added before clamping,
+ *                      so the integral only winds up while the combined output is within range.
+ * @param input         Current error input.
+ * @param setpoint      Target value.
+ * @param feedforward   Feedforward value added to the PID output.
+ * @param period        Change in time since last update.
+ * @param pidObj        Pointer to a PID structure.
+ * @returns             uint32_t: Current output command from the PID controller.
+*/
+uint32_t pidFeedforward(float input, float setpoint, float feedforward, float period, pid_struct *pidObj);
+
 #endif /* PID_H_ */
@@ -24,6 +24,7 @@
 #include "task.h"
 
 #include "adc.h"
+#include "bus.h"
 #include "display.h"
 #include "circBufT.h"
 #include "priorities.h"
@@ -32,27 +33,14 @@
 
 #define BUF_SIZE 10
 
-extern systemState systemStatus;
-
-xQueueHandle g_ADCQueue;
-
-extern xSemaphoreHandle g_UARTMutex;
-
 bool bufferFull;
 
 static circBuf_t g_inBuffer;
 
-/*Calculate the reference altitude using data stored in the circular buffer when the buffer is full*/
-void calibrateReferenceAlt(void) {
-    if(bufferFull) {
-        systemStatus.referenceAlt = (((g_inBuffer.sum << 1) + BUF_SIZE) >> 1) / BUF_SIZE;
-    }
-}
-
 static void ADCTask(void *pvParameters) {
     portTickType ui16LastTime;
     uint8_t ui8bufferVals = 0;
-    uint32_t ui32pollDelay = 3;
+    uint32_t ui32pollDelay = ADC_PERIOD_MS;
 
     ui16LastTime = xTaskGetTickCount();
 
@@ -62,16 +50,8 @@ static void ADCTask(void *pvParameters) {
         if (bufferFull) {
             uint32_t ui32avgHGT = (((g_inBuffer.sum << 1) + BUF_SIZE) >> 1) / BUF_SIZE;  //Calculate the average height
 
-            if(systemStatus.state == TAKEOFF || systemStatus.state == FLYING || systemStatus.state == LANDING) {
-            // if the state of the system is in 'TAKEOFF', 'FLYING' or 'LANDING'
-
-                if (xQueueSend(g_ADCQueue, (&ui32avgHGT), 0) != pdPASS) {
-                    // if the queue is full
-                    xSemaphoreTake (g_UARTMutex, portMAX_DELAY); // wait portMAX_DELAY to see if it becomes available to access the resource
-                    UARTprintf("\nADC Queue full.\n");  // Print to the UART
-                    xSemaphoreGive (g_UARTMutex);  //We have finished accessing the shared resource so can free the semaphore.
-                }
-            }
+            busPublish(TOPIC_ADC, &ui32avgHGT);
+            // Publish the latest average, the height task is notified and the control task reads it as the landed reference
         }
         else if (!bufferFull) {  //if buffer is not full, incrament ui8bufferVals and check if buffer will be full for the next time
             ui8bufferVals++;
@@ -108,9 +88,6 @@ uint32_t initADCTask(void) {
     //Initialize ADC circular buffer
     initCircBuf (&g_inBuffer, BUF_SIZE);
 
-    //Initialize ADCQueue
-    g_ADCQueue = xQueueCreate(20, sizeof(uint32_t));
-
     // Create FreeRTOS task
     if(xTaskCreate(ADCTask, "ADC", 128, NULL, PRIORITY_ADC_TASK, NULL) != pdTRUE)
     {
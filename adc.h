@@ -9,17 +9,12 @@
 #ifndef ADC_H_
 #define ADC_H_
 
-
-/**
- * @function        calibrateReferenceAlt.
- * @brief           If ADC buffer is full, calculate and store landed reference altitude.
-*/
-void calibrateReferenceAlt(void); 
+#define ADC_PERIOD_MS   3   // Sample period, the height task runs the main rotor controller on every sample
 
 
 /**
  * @function            ADCTask.
- * @brief               ADCTask to be scheduled by FreeRTOS, triggers ADC sampling and adds average reading to the ADCQueue.
+ * @brief               ADCTask to be scheduled by FreeRTOS, triggers ADC sampling and publishes the average reading to TOPIC_ADC.
  * @param pvParameters  Pointer to task parameters (NULL).
 */
 static void ADCTask(void *pvParameters);
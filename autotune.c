@@ -0,0 +1,195 @@
+/*
+ * autotune.c
+ *
+ * Relay feedback autotuning. Altitude is tuned first while yaw is held by its PID,
+ * then yaw while altitude is held with the new gains.
+ *
+ * Has no FreeRTOS or hardware dependencies, time is passed in, so the whole
+ * sequence can be driven by a plant model off target.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "autotune.h"
+#include "pid.h"
+
+#define AUTOTUNE_PI     3.14159265f
+
+// Written by the control task, read by the height and yaw tasks to decide whether a relay is driving
+static volatile autotunePhase_t g_phase = AT_OFF;
+static uint32_t g_phaseStartMs;
+static uint32_t g_settleStartMs;
+static bool g_settling;
+
+static relayTune_t g_altRelay;
+static relayTune_t g_yawRelay;
+
+void relayStart(volatile relayTune_t *relay, float setpoint, float bias, float amplitude, float hysteresis, uint32_t nowMs) {
+    relay->setpoint = setpoint;
+    relay->bias = bias;
+    relay->amplitude = amplitude;
+    relay->hysteresis = hysteresis;
+    relay->high = false;
+    relay->startMs = nowMs;
+    relay->risen = false;
+    relay->lastRiseMs = nowMs;
+    relay->peakMax = setpoint;
+    relay->peakMin = setpoint;
+    relay->cycles = 0;
+    relay->periodSum = 0;
+    relay->peakSum = 0;
+    relay->done = false;
+}
+
+float relayUpdate(relayTune_t *relay, float measurement, uint32_t nowMs) {
+    if (measurement > relay->peakMax) {
+        relay->peakMax = measurement;
+    }
+    if (measurement < relay->peakMin) {
+        relay->peakMin = measurement;
+    }
+
+    if (relay->high && measurement > relay->setpoint + relay->hysteresis) {
+        relay->high = false;
+    }
+    else if (!relay->high && measurement < relay->setpoint - relay->hysteresis) {
+        relay->high = true;
+
+        // Each low to high switch ends one cycle of the oscillation, stop measuring once the result is handed over
+        if (relay->risen && !relay->done) {
+            relay->cycles++;
+            if (relay->cycles > AUTOTUNE_SKIP_CYCLES) {
+                relay->periodSum += nowMs - relay->lastRiseMs;
+                relay->peakSum += relay->peakMax - relay->peakMin;
+            }
+            relay->done = relay->cycles >= AUTOTUNE_SKIP_CYCLES + AUTOTUNE_CYCLES;
+        }
+        relay->risen = true;
+        relay->lastRiseMs = nowMs;
+        relay->peakMax = measurement;
+        relay->peakMin = measurement;
+    }
+    return relay->high ? relay->bias + relay->amplitude : relay->bias - relay->amplitude;
+}
+
+bool relayResult(const relayTune_t *relay, float *Ku, float *Tu) {
+    if (!relay->done) {
+        return false;
+    }
+    uint32_t measured = relay->cycles - AUTOTUNE_SKIP_CYCLES;
+    float a = relay->peakSum / measured / 2;
+
+    if (a <= relay->hysteresis) {
+        return false;
+    }
+    *Ku = 4 * relay->amplitude / (AUTOTUNE_PI * sqrtf(a * a - relay->hysteresis * relay->hysteresis));
+    *Tu = (float)relay->periodSum / measured / 1000;
+    return true;
+}
+
+void relayToGains(float Ku, float Tu, pid_struct *pidObj) {
+    // Kp = Ku / 3, Ti = Tu / 2, Td = Tu / 3
+    pidObj->Kp = 0.33f * Ku;
+    pidObj->Ki = pidObj->Kp / (0.5f * Tu);
+    pidObj->Kd = pidObj->Kp * 0.33f * Tu;
+    // I is kept, it holds the trim in duty and the PID was not run while the relay drove the rotor
+}
+
+static void setPhase(autotunePhase_t phase, uint32_t nowMs) {
+    g_phase = phase;
+    g_phaseStartMs = nowMs;
+    g_settling = false;
+}
+
+/* Returns true once error has stayed within the settle band for AUTOTUNE_SETTLE_MS */
+static bool settled(float error, uint32_t nowMs) {
+    if (fabsf(error) > AUTOTUNE_SETTLE_BAND) {
+        g_settling = false;
+        return false;
+    }
+    if (!g_settling) {
+        g_settling = true;
+        g_settleStartMs = nowMs;
+    }
+    return nowMs - g_settleStartMs >= AUTOTUNE_SETTLE_MS;
+}
+
+void autotuneStart(uint32_t nowMs) {
+    setPhase(AT_ALT_SETTLE, nowMs);
+}
+
+autotunePhase_t autotuneUpdate(float altPercent, float yawDegrees, uint8_t mainDuty, uint8_t tailDuty, uint32_t nowMs, pid_struct *mainPid, pid_struct *tailPid) {
+    float Ku;
+    float Tu;
+
+    if (g_phase != AT_OFF && g_phase != AT_DONE && g_phase != AT_FAILED
+            && nowMs - g_phaseStartMs > AUTOTUNE_TIMEOUT_MS) {
+        setPhase(AT_FAILED, nowMs);
+    }
+
+    switch (g_phase) {
+        case AT_ALT_SETTLE:
+            if (settled(altPercent - AUTOTUNE_ALT, nowMs)) {
+                // Hover duty is the centre of the relay. The relay is filled in before the phase
+                // that lets the height task use it
+                relayStart(&g_altRelay, AUTOTUNE_ALT, mainDuty, AUTOTUNE_ALT_RELAY, AUTOTUNE_ALT_HYST, nowMs);
+                setPhase(AT_ALT_RELAY, nowMs);
+            }
+            break;
+        case AT_ALT_RELAY:
+            if (relayResult(&g_altRelay, &Ku, &Tu)) {
+                relayToGains(Ku, Tu, mainPid);
+                setPhase(AT_YAW_SETTLE, nowMs);
+            }
+            break;
+        case AT_YAW_SETTLE:
+            if (settled(altPercent - AUTOTUNE_ALT, nowMs) && fabsf(yawDegrees) <= AUTOTUNE_SETTLE_BAND) {
+                relayStart(&g_yawRelay, 0, tailDuty, AUTOTUNE_YAW_RELAY, AUTOTUNE_YAW_HYST, nowMs);
+                setPhase(AT_YAW_RELAY, nowMs);
+            }
+            break;
+        case AT_YAW_RELAY:
+            if (relayResult(&g_yawRelay, &Ku, &Tu)) {
+                relayToGains(Ku, Tu, tailPid);
+                setPhase(AT_DONE, nowMs);
+            }
+            break;
+        default:
+            break;
+    }
+    return g_phase;
+}
+
+// Relay output limited to the same 2 - 98% range as the PID output
+static uint8_t relayDuty(float output) {
+    if (output > 98) {
+        return 98;
+    } else if (output < 2) {
+        return 2;
+    }
+    return (uint8_t)output;
+}
+
+bool autotuneMainDuty(float altPercent, uint32_t nowMs, uint8_t *duty) {
+    if (g_phase != AT_ALT_RELAY) {
+        return false;
+    }
+    *duty = relayDuty(relayUpdate(&g_altRelay, altPercent, nowMs));
+    return true;
+}
+
+bool autotuneTailDuty(float yawDegrees, uint32_t nowMs, uint8_t *duty) {
+    if (g_phase != AT_YAW_RELAY) {
+        return false;
+    }
+    *duty = relayDuty(relayUpdate(&g_yawRelay, yawDegrees, nowMs));
+    return true;
+}
+
+void autotuneAbort(void) {
+    g_phase = AT_OFF;
+}
@@ -0,0 +1,186 @@
+/*
+ * autotune.h
+ *
+ * Header for autotune.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pid.h"
+
+#define AUTOTUNE_ALT            50      // Altitude (%) the relay experiments are run around
+#define AUTOTUNE_SETTLE_BAND    2       // Altitude (%) / yaw (degrees) error counted as settled
+#define AUTOTUNE_SETTLE_MS      2000    // Time within the settle band before starting a relay
+#define AUTOTUNE_TIMEOUT_MS     60000   // Give up on a relay experiment after this long
+#define AUTOTUNE_SKIP_CYCLES    2       // Relay cycles ignored while the oscillation builds up
+#define AUTOTUNE_CYCLES         4       // Relay cycles averaged for the ultimate gain and period
+
+#define AUTOTUNE_ALT_RELAY      8       // Main duty step (%) either side of the hover duty
+#define AUTOTUNE_ALT_HYST       1       // Altitude hysteresis (%)
+#define AUTOTUNE_YAW_RELAY      10      // Tail duty step (%) either side of the hover duty
+#define AUTOTUNE_YAW_HYST       2       // Yaw hysteresis (degrees)
+
+
+/**
+ * @enum            autotunePhase.
+ * @brief           Steps of the autotune sequence, altitude is tuned first then yaw.
+*/
+typedef enum _autotunePhase {
+    AT_OFF = 0,
+    AT_ALT_SETTLE,
+    AT_ALT_RELAY,
+    AT_YAW_SETTLE,
+    AT_YAW_RELAY,
+    AT_DONE,
+    AT_FAILED
+} autotunePhase_t;
+
+
+/**
+ * @struct                  relayTune_t.
+ * @brief                   Relay feedback experiment for one axis.
+ * @brief                   The output is switched between bias +/- amplitude each time the measurement crosses
+ *                          the setpoint (with hysteresis), which makes the loop oscillate at its ultimate period.
+ *
+ * @param setpoint          Value the measurement oscillates around.
+ * @param bias              Output at the centre of the relay (the trim duty).
+ * @param amplitude         Relay step either side of bias.
+ * @param hysteresis        Measurement hysteresis either side of setpoint.
+ * @param high              Relay output is currently bias + amplitude.
+ * @param startMs           Time the experiment started.
+ * @param risen             A low to high switch has been seen, lastRiseMs is valid.
+ * @param lastRiseMs        Time of the last low to high switch.
+ * @param peakMax           Largest measurement in the current cycle.
+ * @param peakMin           Smallest measurement in the current cycle.
+ * @param cycles            Complete cycles seen.
+ * @param periodSum         Sum of the measured periods (ms) after the skipped cycles.
+ * @param peakSum           Sum of the measured peak to peak amplitudes after the skipped cycles.
+ * @param done              All cycles measured, the sums are final. Set last so another task can read the result without a lock.
+*/
+typedef struct _relayTune_t {
+    float setpoint;
+    float bias;
+    float amplitude;
+    float hysteresis;
+    bool high;
+    uint32_t startMs;
+    bool risen;
+    uint32_t lastRiseMs;
+    float peakMax;
+    float peakMin;
+    uint32_t cycles;
+    uint32_t periodSum;
+    float peakSum;
+    volatile bool done;
+} relayTune_t;
+
+
+/**
+ * @function            relayStart.
+ * @brief               Start a relay experiment. Writes through a volatile pointer so every field is stored
+ *                      before a later volatile store publishes the relay to another task.
+ * @param relay         Pointer to the relay structure.
+ * @param setpoint      Value the measurement should oscillate around.
+ * @param bias          Trim output at the centre of the relay.
+ * @param amplitude     Relay step either side of bias.
+ * @param hysteresis    Measurement hysteresis either side of setpoint.
+ * @param nowMs         Current time (ms).
+*/
+void relayStart(volatile relayTune_t *relay, float setpoint, float bias, float amplitude, float hysteresis, uint32_t nowMs);
+
+
+/**
+ * @function            relayUpdate.
+ * @brief               Run one step of the relay experiment.
+ * @param relay         Pointer to the relay structure.
+ * @param measurement   Current measurement.
+ * @param nowMs         Current time (ms).
+ * @returns             float: Relay output.
+*/
+float relayUpdate(relayTune_t *relay, float measurement, uint32_t nowMs);
+
+
+/**
+ * @function            relayResult.
+ * @brief               Ultimate gain and period from the averaged cycles, Ku = 4d / (pi * sqrt(a^2 - h^2)).
+ * @param relay         Pointer to the relay structure.
+ * @param Ku            Pointer to store the ultimate gain in.
+ * @param Tu            Pointer to store the ultimate period (s) in.
+ * @returns             bool: true once enough cycles have been measured, else false.
+*/
+bool relayResult(const relayTune_t *relay, float *Ku, float *Tu);
+
+
+/**
+ * @function            relayToGains.
+ * @brief               Set PID gains from the ultimate gain and period (Ziegler-Nichols "some overshoot" rule).
+ * @brief               The integral is kept. It is stored in duty, not scaled by Ki on each update, so it still
+ *                      holds the hover trim the relay was centred on and the output carries on from the trim
+ *                      when the new gains take over in the air. prev_error is also kept, it is from the settled
+ *                      hold before the relay.
+ * @param Ku            Ultimate gain.
+ * @param Tu            Ultimate period (s).
+ * @param pidObj        Pointer to the PID structure to update.
+*/
+void relayToGains(float Ku, float Tu, pid_struct *pidObj);
+
+
+/**
+ * @function            autotuneStart.
+ * @brief               Start the autotune sequence with the altitude settle phase.
+ * @param nowMs         Current time (ms).
+*/
+void autotuneStart(uint32_t nowMs);
+
+
+/**
+ * @function            autotuneUpdate.
+ * @brief               Step the autotune sequence, called every control period. Writes the tuned gains into
+ *                      mainPid / tailPid as each relay experiment completes.
+ * @param altPercent    Current altitude (%).
+ * @param yawDegrees    Current yaw (degrees).
+ * @param mainDuty      Current main rotor duty, used as the altitude relay bias.
+ * @param tailDuty      Current tail rotor duty, used as the yaw relay bias.
+ * @param nowMs         Current time (ms).
+ * @param mainPid       Pointer to the main rotor PID structure.
+ * @param tailPid       Pointer to the tail rotor PID structure.
+ * @returns             autotunePhase_t: Phase after the update (AT_DONE or AT_FAILED when finished).
+*/
+autotunePhase_t autotuneUpdate(float altPercent, float yawDegrees, uint8_t mainDuty, uint8_t tailDuty, uint32_t nowMs, pid_struct *mainPid, pid_struct *tailPid);
+
+
+/**
+ * @function            autotuneMainDuty.
+ * @brief               Main rotor duty from the altitude relay, used in place of the PID output while it runs.
+ * @param altPercent    Current altitude (%).
+ * @param nowMs         Current time (ms).
+ * @param duty          Pointer to store the duty in.
+ * @returns             bool: true if the altitude relay is running and duty was written, else false.
+*/
+bool autotuneMainDuty(float altPercent, uint32_t nowMs, uint8_t *duty);
+
+
+/**
+ * @function            autotuneTailDuty.
+ * @brief               Tail rotor duty from the yaw relay, used in place of the PID output while it runs.
+ * @param yawDegrees    Current yaw (degrees).
+ * @param nowMs         Current time (ms).
+ * @param duty          Pointer to store the duty in.
+ * @returns             bool: true if the yaw relay is running and duty was written, else false.
+*/
+bool autotuneTailDuty(float yawDegrees, uint32_t nowMs, uint8_t *duty);
+
+
+/**
+ * @function            autotuneAbort.
+ * @brief               Stop the autotune sequence, leaving the gains as they are.
+*/
+void autotuneAbort(void);
+
+#endif /* AUTOTUNE_H_ */
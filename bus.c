@@ -0,0 +1,109 @@
+/*
+ * bus.c
+ *
+ * Publish / subscribe data bus. Each topic holds the latest value behind a
+ * sequence lock, so publishing never blocks and a new reader costs nothing
+ * on the writer's side beyond an optional task notification.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "bus.h"
+#include "seqlock.h"
+#include "shared.h"
+
+/**
+ * @struct              busTopic_t.
+ * @brief               Storage and bookkeeping for one topic.
+ *
+ * @param copies        Two copies of the value, for the sequence lock.
+ * @param size          Size of one value in bytes.
+ * @param lock          Sequence lock over copies, its count / 2 is the number of publishes.
+ * @param lastTick      Tick count of the last publish.
+ * @param subscribers   Tasks to notify on each publish.
+ * @param bits          Notification bits to set on each subscriber.
+ * @param numSubscribers Number of subscribers.
+*/
+typedef struct _busTopic_t {
+    void * const copies;
+    const size_t size;
+    seqlock_t lock;
+    volatile uint32_t lastTick;
+    xTaskHandle subscribers[BUS_MAX_SUBSCRIBERS];
+    uint32_t bits[BUS_MAX_SUBSCRIBERS];
+    uint8_t numSubscribers;
+} busTopic_t;
+
+static flightStatus_t g_stateCopies[2];
+static altStatus_t g_altitudeCopies[2];
+static yawStatus_t g_yawCopies[2];
+static uint8_t g_mainDutyCopies[2];
+static uint8_t g_tailDutyCopies[2];
+static inputStatus_t g_inputsCopies[2];
+static uint32_t g_adcCopies[2];
+
+#define BUS_TOPIC(storage)      { .copies = (storage), .size = sizeof((storage)[0]) }
+
+static busTopic_t g_topics[NUM_TOPICS] = {
+    [TOPIC_STATE] = BUS_TOPIC(g_stateCopies),
+    [TOPIC_ALTITUDE] = BUS_TOPIC(g_altitudeCopies),
+    [TOPIC_YAW] = BUS_TOPIC(g_yawCopies),
+    [TOPIC_MAIN_DUTY] = BUS_TOPIC(g_mainDutyCopies),
+    [TOPIC_TAIL_DUTY] = BUS_TOPIC(g_tailDutyCopies),
+    [TOPIC_INPUTS] = BUS_TOPIC(g_inputsCopies),
+    [TOPIC_ADC] = BUS_TOPIC(g_adcCopies)
+};
+
+void busPublish(topic_t topic, const void *value) {
+    busTopic_t *entry = &g_topics[topic];
+    uint8_t i;
+
+    seqlockWrite(&entry->lock, entry->copies, value, entry->size);
+    entry->lastTick = xTaskGetTickCount();
+
+    for (i = 0; i < entry->numSubscribers; i++) {
+        xTaskNotify(entry->subscribers[i], entry->bits[i], eSetBits);
+    }
+}
+
+uint32_t busRead(topic_t topic, void *value) {
+    busTopic_t *entry = &g_topics[topic];
+
+    return seqlockRead(&entry->lock, entry->copies, value, entry->size) >> 1;
+}
+
+uint32_t busUpdates(topic_t topic) {
+    return g_topics[topic].lock.sequence >> 1;
+}
+
+uint32_t busAge(topic_t topic, uint32_t nowTick) {
+    return nowTick - g_topics[topic].lastTick;
+}
+
+bool busSubscribe(topic_t topic, xTaskHandle task, uint32_t bits) {
+    busTopic_t *entry = &g_topics[topic];
+
+    if (entry->numSubscribers >= BUS_MAX_SUBSCRIBERS) {
+        return false;
+    }
+    entry->subscribers[entry->numSubscribers] = task;
+    entry->bits[entry->numSubscribers] = bits;
+    entry->numSubscribers++;
+    return true;
+}
+
+void readSystemState(systemState *state) {
+    busRead(TOPIC_STATE, &state->flight);
+    busRead(TOPIC_ALTITUDE, &state->alt);
+    busRead(TOPIC_YAW, &state->yaw);
+    busRead(TOPIC_MAIN_DUTY, &state->mainPWMDuty);
+    busRead(TOPIC_TAIL_DUTY, &state->tailPWMDuty);
+    busRead(TOPIC_INPUTS, &state->input);
+}
@@ -0,0 +1,102 @@
+/*
+ * bus.h
+ *
+ * Header for bus.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef BUS_H_
+#define BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "shared.h"
+
+#define BUS_MAX_SUBSCRIBERS     2       // Tasks notified per topic
+#define BUS_NOTIFY_UPDATED      0x01    // Notification bit for subscribers that wait with ulTaskNotifyTake
+
+/**
+ * @enum            topic_t.
+ * @brief           Fixed topics on the data bus. Each has one writer and any number of readers,
+ *                  readers always get the latest complete value.
+*/
+typedef enum _topic_t {
+    TOPIC_STATE = 0,    // flightStatus_t, control task
+    TOPIC_ALTITUDE,     // altStatus_t, height task
+    TOPIC_YAW,          // yawStatus_t, yaw task
+    TOPIC_MAIN_DUTY,    // uint8_t main rotor duty (%), height task
+    TOPIC_TAIL_DUTY,    // uint8_t tail rotor duty (%), yaw task
+    TOPIC_INPUTS,       // inputStatus_t, inputs task
+    TOPIC_ADC,          // uint32_t averaged raw altitude sample, ADC task
+    NUM_TOPICS
+} topic_t;
+
+// Topic names for status output
+static const char *topicNames[NUM_TOPICS] = {"state", "alt", "yaw", "main", "tail", "inputs", "adc"};
+
+
+/**
+ * @function        busPublish.
+ * @brief           Publish a new value and notify the topic's subscribers. Never blocks.
+ *                  Must only be called from the topic's one writer task.
+ * @param topic     Topic to publish to.
+ * @param value     Pointer to the new value, of the topic's type.
+*/
+void busPublish(topic_t topic, const void *value);
+
+
+/**
+ * @function        busRead.
+ * @brief           Take a consistent copy of the latest value without locking.
+ * @param topic     Topic to read.
+ * @param value     Pointer to fill, of the topic's type. Left zeroed until the first publish.
+ * @returns         uint32_t: Number of times the topic has been published, 0 if never.
+*/
+uint32_t busRead(topic_t topic, void *value);
+
+
+/**
+ * @function        busUpdates.
+ * @brief           Number of times a topic has been published, e.g. to check for a new value without copying it.
+ * @param topic     Topic to check.
+ * @returns         uint32_t: Publish count.
+*/
+uint32_t busUpdates(topic_t topic);
+
+
+/**
+ * @function        busAge.
+ * @brief           Time since a topic was last published.
+ * @param topic     Topic to check.
+ * @param nowTick   Current tick count.
+ * @returns         uint32_t: Ticks since the last publish, or nowTick if never published.
+*/
+uint32_t busAge(topic_t topic, uint32_t nowTick);
+
+
+/**
+ * @function        busSubscribe.
+ * @brief           Set notification bits on a task every time a topic is published, so a task waiting on
+ *                  several sources with xTaskNotifyWait can tell them apart.
+ *                  Call before the scheduler starts, subscriptions are not locked.
+ * @param topic     Topic to subscribe to.
+ * @param task      Task to notify.
+ * @param bits      Notification bits to set, BUS_NOTIFY_UPDATED if the task only waits on this topic.
+ * @returns         bool: true if subscribed, false if the topic already has BUS_MAX_SUBSCRIBERS.
+*/
+bool busSubscribe(topic_t topic, xTaskHandle task, uint32_t bits);
+
+
+/**
+ * @function        readSystemState.
+ * @brief           Read every state topic, e.g. for the display and UART. Each topic is consistent on its own.
+ * @param state     Pointer to the snapshot to fill.
+*/
+void readSystemState(systemState *state);
+
+#endif /* BUS_H_ */
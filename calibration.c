@@ -0,0 +1,125 @@
+/*
+ * calibration.c
+ *
+ * Persistent calibration record (reference altitude, yaw offset and PID gains)
+ * stored in the TM4C123 EEPROM, or in a file when built for the host.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef HOST_BUILD
+#include <stdio.h>
+#else
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+#endif
+
+#include "calibration.h"
+#include "pid.h"
+
+// Number of bytes covered by the CRC (everything before the crc field)
+#define CALIB_CRC_LENGTH    offsetof(calibRecord_t, crc)
+
+/* Bitwise CRC-32, only run on startup and when saving so a lookup table is not worth the flash */
+uint32_t calibCrc32(const uint8_t *data, uint32_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t i;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+#ifdef HOST_BUILD
+
+bool initCalibrationStore(void) {
+    return true;
+}
+
+static bool readRecord(calibRecord_t *record) {
+    FILE *file = fopen(CALIB_HOST_FILE, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t read = fread(record, sizeof(calibRecord_t), 1, file);
+    fclose(file);
+    return read == 1;
+}
+
+static bool writeRecord(calibRecord_t *record) {
+    FILE *file = fopen(CALIB_HOST_FILE, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t written = fwrite(record, sizeof(calibRecord_t), 1, file);
+    fclose(file);
+    return written == 1;
+}
+
+#else
+
+bool initCalibrationStore(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0));
+
+    // EEPROMInit recovers from an interrupted write, anything else means the EEPROM can't be trusted
+    return EEPROMInit() == EEPROM_INIT_OK;
+}
+
+static bool readRecord(calibRecord_t *record) {
+    EEPROMRead((uint32_t *)record, CALIB_EEPROM_ADDR, sizeof(calibRecord_t));
+    return true;
+}
+
+static bool writeRecord(calibRecord_t *record) {
+    return EEPROMProgram((uint32_t *)record, CALIB_EEPROM_ADDR, sizeof(calibRecord_t)) == 0;
+}
+
+#endif
+
+bool loadCalibration(calibRecord_t *record) {
+    if (!readRecord(record)) {
+        return false;
+    }
+    if (record->magic != CALIB_MAGIC || record->version != CALIB_VERSION) {
+        return false;
+    }
+    return record->crc == calibCrc32((const uint8_t *)record, CALIB_CRC_LENGTH);
+}
+
+bool saveCalibration(calibRecord_t *record) {
+    record->magic = CALIB_MAGIC;
+    record->version = CALIB_VERSION;
+    record->crc = calibCrc32((const uint8_t *)record, CALIB_CRC_LENGTH);
+    return writeRecord(record);
+}
+
+void applyCalibrationGains(const calibRecord_t *record, pid_struct *mainPid, pid_struct *tailPid) {
+    mainPid->Kp = record->mainKp;
+    mainPid->Ki = record->mainKi;
+    mainPid->Kd = record->mainKd;
+    tailPid->Kp = record->tailKp;
+    tailPid->Ki = record->tailKi;
+    tailPid->Kd = record->tailKd;
+}
+
+void storeCalibrationGains(calibRecord_t *record, const pid_struct *mainPid, const pid_struct *tailPid) {
+    record->mainKp = mainPid->Kp;
+    record->mainKi = mainPid->Ki;
+    record->mainKd = mainPid->Kd;
+    record->tailKp = tailPid->Kp;
+    record->tailKi = tailPid->Ki;
+    record->tailKd = tailPid->Kd;
+}
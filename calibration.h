@@ -0,0 +1,110 @@
+/*
+ * calibration.h
+ *
+ * Header for calibration.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pid.h"
+
+#define CALIB_MAGIC             0x48454C49  // "HELI"
+#define CALIB_VERSION           1           // Bump whenever calibRecord_t changes layout
+#define CALIB_EEPROM_ADDR       0x0000      // Byte address of the record in EEPROM (word aligned)
+#define CALIB_ALT_TOLERANCE     40          // Max raw ADC difference between stored and landed altitude to skip calibration
+#define CALIB_HOST_FILE         "calibration.bin"   // Backing file used instead of EEPROM in a HOST_BUILD
+
+
+/**
+ * @struct                  calibRecord_t.
+ * @brief                   Calibration record stored in EEPROM, whole words so it can be passed to EEPROMProgram directly.
+ *
+ * @param magic             CALIB_MAGIC, identifies an initialised record.
+ * @param version           CALIB_VERSION the record was written with.
+ * @param referenceAlt      Landed reference raw altitude.
+ * @param yawOffset         Yaw count relative to the reference slot when the record was saved (heli parked position).
+ * @param mainKp            Main rotor proportional gain.
+ * @param mainKi            Main rotor integral gain.
+ * @param mainKd            Main rotor derivative gain.
+ * @param tailKp            Tail rotor proportional gain.
+ * @param tailKi            Tail rotor integral gain.
+ * @param tailKd            Tail rotor derivative gain.
+ * @param crc               CRC-32 over all preceding fields.
+*/
+typedef struct _calibRecord_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t referenceAlt;
+    int32_t yawOffset;
+    float mainKp;
+    float mainKi;
+    float mainKd;
+    float tailKp;
+    float tailKi;
+    float tailKd;
+    uint32_t crc;
+} calibRecord_t;
+
+
+/**
+ * @function        calibCrc32.
+ * @brief           Calculate the CRC-32 (IEEE 802.3, reflected) of a block of bytes.
+ * @param data      Pointer to the data.
+ * @param length    Number of bytes.
+ * @returns         uint32_t: CRC of the data.
+*/
+uint32_t calibCrc32(const uint8_t *data, uint32_t length);
+
+
+/**
+ * @function        initCalibrationStore.
+ * @brief           Enable the EEPROM peripheral (no-op in a HOST_BUILD).
+ * @returns         bool: true if the storage is ready to use.
+*/
+bool initCalibrationStore(void);
+
+
+/**
+ * @function        loadCalibration.
+ * @brief           Read the stored record, checking magic, version and CRC.
+ * @param record    Pointer to the record to fill.
+ * @returns         bool: true if a valid record was read.
+*/
+bool loadCalibration(calibRecord_t *record);
+
+
+/**
+ * @function        saveCalibration.
+ * @brief           Fill in magic, version and CRC and write the record to storage.
+ * @param record    Pointer to the record to write.
+ * @returns         bool: true if the record was written.
+*/
+bool saveCalibration(calibRecord_t *record);
+
+
+/**
+ * @function        applyCalibrationGains.
+ * @brief           Copy the stored gains into the rotor PID structures.
+ * @param record    Pointer to a valid record.
+ * @param mainPid   Pointer to the main rotor PID structure.
+ * @param tailPid   Pointer to the tail rotor PID structure.
+*/
+void applyCalibrationGains(const calibRecord_t *record, pid_struct *mainPid, pid_struct *tailPid);
+
+
+/**
+ * @function        storeCalibrationGains.
+ * @brief           Copy the gains from the rotor PID structures into a record.
+ * @param record    Pointer to the record to update.
+ * @param mainPid   Pointer to the main rotor PID structure.
+ * @param tailPid   Pointer to the tail rotor PID structure.
+*/
+void storeCalibrationGains(calibRecord_t *record, const pid_struct *mainPid, const pid_struct *tailPid);
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,97 @@
+/*
+ * chart.c
+ *
+ * Scrolling strip chart for the OLED display. Samples are averaged into columns kept in a ring buffer,
+ * each new column scrolls the chart one pixel rather than redrawing it.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chart.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOled.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOledGrph.h"
+
+// Draw one column of every trace at display column x, the area must already be clear
+static void drawColumn(const chart_t *chart, uint8_t index, int x) {
+    int traceHeight = (chart->lastPage - chart->firstPage + 1) * 8 / CHART_TRACES;
+    int limit = traceHeight / 2 - 1;        // Leave a gap between the traces
+    uint8_t trace;
+
+    for (trace = 0; trace < CHART_TRACES; trace++) {
+        int zeroRow = chart->firstPage * 8 + trace * traceHeight + traceHeight / 2;
+        int rows = chart->columns[trace][index] / chart->scales[trace];
+
+        if (rows > limit) {
+            rows = limit;
+        } else if (rows < -limit) {
+            rows = -limit;
+        }
+
+        // Bar from the zero line, positive values upwards. LineTo leaves out the end pixel.
+        OrbitOledMoveTo(x, zeroRow);
+        OrbitOledLineTo(x, zeroRow - rows);
+        OrbitOledDrawPixel();
+    }
+}
+
+void chartReset(chart_t *chart) {
+    uint8_t trace;
+
+    chart->head = 0;
+    chart->count = 0;
+    chart->samples = 0;
+    for (trace = 0; trace < CHART_TRACES; trace++) {
+        chart->sums[trace] = 0;
+    }
+}
+
+bool chartSample(chart_t *chart, const int32_t *values) {
+    uint8_t trace;
+
+    for (trace = 0; trace < CHART_TRACES; trace++) {
+        chart->sums[trace] += values[trace];
+    }
+    chart->samples++;
+    if (chart->samples < chart->decimation) {
+        return false;
+    }
+
+    for (trace = 0; trace < CHART_TRACES; trace++) {
+        chart->columns[trace][chart->head] = chart->sums[trace] / chart->samples;
+        chart->sums[trace] = 0;
+    }
+    chart->samples = 0;
+    chart->head = (chart->head + 1) % CHART_COLUMNS;
+    if (chart->count < CHART_COLUMNS) {
+        chart->count++;
+    }
+    return true;
+}
+
+void chartDraw(chart_t *chart) {
+    uint8_t i;
+
+    // Scrolling the whole width clears the area
+    OrbitOledScrollLeft(chart->firstPage, chart->lastPage, CHART_COLUMNS);
+    OrbitOledSetDrawMode(modOledSet);
+    OrbitOledSetDrawColor(1);
+
+    for (i = 0; i < chart->count; i++) {
+        uint8_t index = (chart->head + CHART_COLUMNS - chart->count + i) % CHART_COLUMNS;
+        drawColumn(chart, index, CHART_COLUMNS - chart->count + i);
+    }
+}
+
+void chartScroll(chart_t *chart) {
+    if (chart->count == 0) {
+        return;
+    }
+
+    OrbitOledScrollLeft(chart->firstPage, chart->lastPage, 1);
+    OrbitOledSetDrawMode(modOledSet);
+    OrbitOledSetDrawColor(1);
+    drawColumn(chart, (chart->head + CHART_COLUMNS - 1) % CHART_COLUMNS, CHART_COLUMNS - 1);
+}
@@ -0,0 +1,81 @@
+/*
+ * chart.h
+ *
+ * Header for chart.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef CHART_H_
+#define CHART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CHART_COLUMNS   128     // One column per pixel across the display
+#define CHART_TRACES    2       // Traces stacked top to bottom in the chart area
+
+
+/**
+ * @struct              chart_t.
+ * @brief               Scrolling strip chart of recent history, drawn into whole OLED pages.
+ * @brief               Settings are fixed, the sample history is kept in a ring buffer so the chart can be redrawn at any time.
+ *
+ * @param firstPage     First display page (8 rows) of the chart area.
+ * @param lastPage      Last display page of the chart area, shared equally between the traces.
+ * @param decimation    Samples averaged into each column.
+ * @param scales        Value per pixel for each trace, drawn as a bar from the trace's zero line.
+ * @param columns       Ring buffer of averaged values, one per column.
+ * @param head          Next columns entry to overwrite.
+ * @param count         Number of columns held (up to CHART_COLUMNS).
+ * @param sums          Sum of the samples for the column being averaged.
+ * @param samples       Number of samples in sums.
+*/
+typedef struct _chart_t {
+    const uint8_t firstPage;
+    const uint8_t lastPage;
+    const uint8_t decimation;
+    const int16_t scales[CHART_TRACES];
+    int16_t columns[CHART_TRACES][CHART_COLUMNS];
+    uint8_t head;
+    uint8_t count;
+    int32_t sums[CHART_TRACES];
+    uint8_t samples;
+} chart_t;
+
+
+/**
+ * @function        chartReset.
+ * @brief           Forget the chart history, e.g. at the start of a flight.
+ * @param chart     Pointer to a chart structure.
+*/
+void chartReset(chart_t *chart);
+
+
+/**
+ * @function        chartSample.
+ * @brief           Add one sample per trace, completing a column every decimation samples.
+ * @param chart     Pointer to a chart structure.
+ * @param values    CHART_TRACES values, in the traces' units.
+ * @returns         bool: true if a new column was completed, else false.
+*/
+bool chartSample(chart_t *chart, const int32_t *values);
+
+
+/**
+ * @function        chartDraw.
+ * @brief           Clear the chart area and draw the whole history into the OLED buffer, newest column on the right.
+ * @param chart     Pointer to a chart structure.
+*/
+void chartDraw(chart_t *chart);
+
+
+/**
+ * @function        chartScroll.
+ * @brief           Scroll the chart area left one column and draw only the newest column,
+ *                  after chartSample completes one. Costs the same however much history is held.
+ * @param chart     Pointer to a chart structure.
+*/
+void chartScroll(chart_t *chart);
+
+#endif /* CHART_H_ */
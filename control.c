@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
@@ -19,22 +20,41 @@
 #include "utils/uartstdio.h"
 
 #include "adc.h"
+#include "autotune.h"
+#include "bus.h"
+#include "calibration.h"
 #include "control.h"
+#include "fsm.h"
+#include "lqrGains.h"
 #include "shared.h"
 #include "height.h"
+#include "trajectory.h"
 #include "pid.h"
 #include "priorities.h"
+#include "stateFeedback.h"
+#include "sysid.h"
 #include "uart.h"
 #include "userInputs.h"
 #include "yaw.h"
 
-extern systemState systemStatus;
+// Flight state and setpoints, this task is the only writer of TOPIC_STATE and publishes it once per period
+static flightStatus_t g_flight;
+
+// Snapshots of the topics written by the other tasks, refreshed at the start of each period
+static altStatus_t g_alt;
+static yawStatus_t g_yaw;
+static uint8_t g_mainDuty;
+static uint8_t g_tailDuty;
+static inputStatus_t g_input;
 
 extern xQueueHandle g_InputQueue;
 
 extern xSemaphoreHandle g_UARTMutex;
-extern xSemaphoreHandle g_StatusMutex;
-extern xSemaphoreHandle g_yawCalibrated;
+
+static xTaskHandle g_controlTaskHandle = NULL;
+
+// Set when the yaw reference interrupt reports the slot, until calibration uses it
+static bool g_yawReferenceFound = false;
 
 /* set up the PID control variables and PWM range for main rotor*/
 pid_struct main_rotor = {
@@ -44,7 +64,8 @@ pid_struct main_rotor = {
     .prev_error = 0,
     .I = 0,
     .output_min = 2,
-    .output_max = 98
+    .output_max = 98,
+    .scale = NULL
 };
 
 /* set up the PID control variables and PWM range for tail rotor*/
@@ -55,124 +76,444 @@ pid_struct tail_rotor = {
     .prev_error = 0,
     .I = 0,
     .output_min = 2,
+    .output_max = 98,
+    .scale = NULL
+};
+
+/* select the controller for each axis, the state feedback gains come from tools/lqr_design.py*/
+controller_t g_mainController = CTRL_PID;
+controller_t g_tailController = CTRL_PID;
+
+/* set up the state feedback gains, rate filter and PWM range for main rotor*/
+sf_struct main_state_feedback = {
+    .K = LQR_MAIN_GAINS,
+    .rate_alpha = 0.2,
+    .prev_input = 0,
+    .rate = 0,
+    .I = 0,
+    .output_min = 2,
     .output_max = 98
 };
 
+/* set up the state feedback gains, rate filter and PWM range for tail rotor*/
+sf_struct tail_state_feedback = {
+    .K = LQR_TAIL_GAINS,
+    .rate_alpha = 0.2,
+    .prev_input = 0,
+    .rate = 0,
+    .I = 0,
+    .output_min = 2,
+    .output_max = 98
+};
+
+/* set up the altitude setpoint limits (percent/s, percent/s^2, 200 ms S-curve)*/
+trajectory_t alt_trajectory = {
+    .maxVel = 20,
+    .maxAcc = 40,
+    .jerkTicks = 20
+};
+
+/* set up the yaw setpoint limits (degrees/s, degrees/s^2, 100 ms S-curve)*/
+trajectory_t yaw_trajectory = {
+    .maxVel = 90,
+    .maxAcc = 180,
+    .jerkTicks = 10
+};
+
+fsm_t g_flightFsm;
+
+// Calibration record loaded from EEPROM, g_calibRestored is cleared if it turns out to be stale
+static calibRecord_t g_calibRecord;
+static bool g_calibRestored = false;
+
+/* Save the current reference altitude, yaw position and gains so the next power-up can skip calibration */
+static void saveCalibrationRecord(void) {
+    g_calibRecord.referenceAlt = g_flight.referenceAlt;
+    g_calibRecord.yawOffset = (int32_t)yawCount();
+    storeCalibrationGains(&g_calibRecord, &main_rotor, &tail_rotor);
+    if (!saveCalibration(&g_calibRecord)) {
+        xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
+        UARTprintf("\nCalibration save failed.\n");
+        xSemaphoreGive(g_UARTMutex);
+    }
+}
+
+/* ------------------------------------------------
+ *  Flight state machine guards, actions and updates
+ * ------------------------------------------------
+ */
+
+static bool systemOn(void) {
+    return g_input.system_on;
+}
+
+static void yawLeft(void) {
+    g_flight.targetYaw = yawWrapDegrees(g_flight.targetYaw - 10);
+}
+
+static void yawRight(void) {
+    g_flight.targetYaw = yawWrapDegrees(g_flight.targetYaw + 10);
+}
+
+static void altUp(void) {
+    if(g_flight.targetAlt < 100) {
+        g_flight.targetAlt += 10;
+    }
+}
+
+static void altDown(void) {
+    if(g_flight.targetAlt > 0) {
+        g_flight.targetAlt -= 10;
+    }
+}
+
+static void yawHome(void) {
+    g_flight.targetYaw = 0;
+}
+
+static void startTakeoff(void) {
+    //set the target yaw and target altitude for the system
+    g_flight.targetYaw = 0;
+    g_flight.targetAlt = 10;
+}
+
+static void startLanding(void) {
+    //turn back to the reference before descending
+    g_flight.targetYaw = 0;
+}
+
+static void landFromMinAlt(void) {
+    //hold the minimum flying altitude while the heli turns back to the reference
+    g_flight.targetAlt = 10;
+    startLanding();
+}
+
+static bool calibratedAndOn(void) {
+    return g_input.system_on && g_flight.yawCalibrated;
+}
+
+// Gains in use before the tune, put back if it doesn't finish so a half tuned set is never saved
+static calibRecord_t g_autotunePrevGains;
+
+static void startAutotune(void) {
+    storeCalibrationGains(&g_autotunePrevGains, &main_rotor, &tail_rotor);
+    g_flight.targetYaw = 0;
+    g_flight.targetAlt = AUTOTUNE_ALT;
+    autotuneStart(xTaskGetTickCount() * portTICK_RATE_MS);
+}
+
+static void finishAutotune(void) {
+    saveCalibrationRecord();    //keep the tuned gains for the next power-up
+    startLanding();
+}
+
+static void abortAutotune(void) {
+    autotuneAbort();
+    applyCalibrationGains(&g_autotunePrevGains, &main_rotor, &tail_rotor);
+    startLanding();
+}
+
+// Identification run axis, settle timer and progress
+static sysidAxis_t g_sysidAxis;
+static bool g_sysidRunning;
+static bool g_sysidSettling;
+static uint32_t g_sysidSettleStart;
+
+static void startSysid(sysidAxis_t axis) {
+    g_flight.targetYaw = 0;
+    g_flight.targetAlt = SYSID_ALT;
+    g_sysidAxis = axis;
+    g_sysidRunning = false;
+    g_sysidSettling = false;
+}
+
+static void startSysidMain(void) {
+    startSysid(SYSID_MAIN);
+}
+
+static void startSysidTail(void) {
+    startSysid(SYSID_TAIL);
+}
+
+static void abortSysid(void) {
+    sysidStop();
+    g_sysidRunning = false;
+    startLanding();
+}
+
+static flightEvent_t calibrateUpdate(void) {
+    if (g_flight.yawCalibrated) {
+    //yaw is already calibrated if the heli has landed and the user wants to takeoff again
+        return EV_YAW_CALIBRATED;
+    }
+    uint32_t ui32LandedAlt;
+    if (busRead(TOPIC_ADC, &ui32LandedAlt) == 0) {
+        return EV_NONE;  //wait for the ADC buffer to fill
+    }
+    if (g_calibRestored) {
+    //if a stored calibration was loaded, check it still matches the landed altitude before using it
+        if (abs((int32_t)(ui32LandedAlt - g_calibRecord.referenceAlt)) <= CALIB_ALT_TOLERANCE) {
+            g_flight.referenceAlt = g_calibRecord.referenceAlt;
+            yawRestoreReference(g_calibRecord.yawOffset);    //left alone if the reference slot has already been seen
+            g_yawReferenceFound = false;
+            g_flight.yawCalibrated = true;
+            return EV_YAW_CALIBRATED;   //skip the spin-up calibration
+        }
+        g_calibRestored = false;    //stored record is stale, fall back to spinning to the reference
+    }
+    g_flight.referenceAlt = ui32LandedAlt;    //the landed altitude is the reference, the yaw task spins the tail meanwhile
+    if (g_yawReferenceFound) {
+    //if a reference point is just found (the reference interrupt has already zeroed the yaw count)
+        g_yawReferenceFound = false;
+        g_flight.yawCalibrated = true;
+        saveCalibrationRecord();
+        return EV_YAW_CALIBRATED;
+    }
+    return EV_NONE;
+}
+
+static flightEvent_t takeoffUpdate(void) {
+    return (g_alt.currentAltPercent >= 10) ? EV_ALT_REACHED : EV_NONE;
+}
+
+static flightEvent_t flyingUpdate(void) {
+    //If the target altitude is changed by the user to be below 10, land
+    return (g_flight.targetAlt < 10) ? EV_LAND_REQUEST : EV_NONE;
+}
+
+static flightEvent_t landingUpdate(void) {
+    if(abs(yawWrapDegrees(g_yaw.currentYawDegrees - g_flight.targetYaw)) < 5) {
+        g_flight.targetAlt = 0;
+        if(g_alt.currentAltPercent < 1) {
+            return EV_LANDED;
+        }
+    }
+    return EV_NONE;
+}
+
+/* Advance the setpoints towards the targets while flying, otherwise hold them at the measured
+   position so the next takeoff starts from where the heli actually is */
+static void updateSetpoints(float period) {
+    float refAlt;
+    float refYaw;
+
+    if (isFlightState((programState)g_flightFsm.state)) {
+        refAlt = trajectoryUpdate(&alt_trajectory, g_flight.targetAlt, period);
+        // Head for the target the short way round, the trajectory itself doesn't wrap
+        refYaw = trajectoryUpdate(&yaw_trajectory, yawNearest(g_flight.targetYaw, yaw_trajectory.profile), period);
+    } else {
+        trajectoryReset(&alt_trajectory, g_alt.currentAltPercent);
+        trajectoryReset(&yaw_trajectory, g_yaw.currentYawDegrees);
+        refAlt = alt_trajectory.position;
+        refYaw = yaw_trajectory.position;
+    }
+    g_flight.refAlt = refAlt;
+    g_flight.refYaw = yawNearest(refYaw, 0);
+}
+
+static flightEvent_t autotuneUpdateState(void) {
+    autotunePhase_t phase = autotuneUpdate(g_alt.currentAltPercent, g_yaw.currentYawDegrees,
+                                           g_mainDuty, g_tailDuty,
+                                           xTaskGetTickCount() * portTICK_RATE_MS, &main_rotor, &tail_rotor);
+
+    if (phase == AT_DONE) {
+        return EV_AUTOTUNE_DONE;
+    } else if (phase == AT_FAILED) {
+        return EV_AUTOTUNE_FAILED;
+    }
+    return EV_NONE;
+}
+
+/* Hold the trim point for AUTOTUNE_SETTLE_MS, then excite the selected rotor. A tail run is logged here every
+   period, a main run by the height task at its own rate */
+static flightEvent_t sysidUpdateState(void) {
+    uint32_t ui32NowMs = xTaskGetTickCount() * portTICK_RATE_MS;
+
+    if (!g_sysidRunning) {
+        if (abs(g_alt.currentAltPercent - SYSID_ALT) > AUTOTUNE_SETTLE_BAND) {
+            g_sysidSettling = false;
+        } else if (!g_sysidSettling) {
+            g_sysidSettling = true;
+            g_sysidSettleStart = ui32NowMs;
+        } else if (ui32NowMs - g_sysidSettleStart >= AUTOTUNE_SETTLE_MS) {
+            sysidStart(g_sysidAxis, SYSID_SIGNAL, ui32NowMs);
+            g_sysidRunning = true;
+        }
+        return EV_NONE;
+    }
+
+    if (g_sysidAxis == SYSID_TAIL) {
+        sysidLog(ui32NowMs, g_mainDuty, g_tailDuty, g_alt.currentAltPercent, g_yaw.currentYawDegrees);
+    }
+    if (!sysidLogging(g_sysidAxis)) {
+        //the run stops itself once SYSID_DURATION_MS has passed
+        g_sysidRunning = false;
+        return EV_SYSID_DONE;
+    }
+    return EV_NONE;
+}
+
+// Work done every control period in each state, returns an internal event (or EV_NONE).
+// States without an update (IDLE) don't need the periodic tick and only wake for events.
+static flightEvent_t (* const stateUpdate[NUM_PROGRAM_STATES])(void) = {
+    [IDLE] = NULL,
+    [CALIBRATE] = calibrateUpdate,
+    [TAKEOFF] = takeoffUpdate,
+    [FLYING] = flyingUpdate,
+    [LANDING] = landingUpdate,
+    [AUTOTUNE] = autotuneUpdateState,
+    [SYSID] = sysidUpdateState
+};
+
+// Flight state transition table, state x event -> guard, action, next state. Empty cells ignore the event.
+static const fsmTransition_t flightTable[NUM_PROGRAM_STATES][NUM_FLIGHT_EVENTS] = {
+    [IDLE] = {
+        [EV_UP_BUTTON]      = FSM_TRANSITION(systemOn, NULL, CALIBRATE),
+        [EV_DOWN_BUTTON]    = FSM_TRANSITION(calibratedAndOn, startAutotune, AUTOTUNE),
+        [EV_LEFT_BUTTON]    = FSM_TRANSITION(calibratedAndOn, startSysidMain, SYSID),
+        [EV_RIGHT_BUTTON]   = FSM_TRANSITION(calibratedAndOn, startSysidTail, SYSID)
+    },
+    [CALIBRATE] = {
+        [EV_YAW_CALIBRATED] = FSM_TRANSITION(NULL, startTakeoff, TAKEOFF),
+        [EV_SWITCH_OFF]     = FSM_TRANSITION(NULL, NULL, IDLE)
+    },
+    [TAKEOFF] = {
+        [EV_ALT_REACHED]    = FSM_TRANSITION(NULL, NULL, FLYING),
+        [EV_SWITCH_OFF]     = FSM_TRANSITION(NULL, startLanding, LANDING)
+    },
+    [FLYING] = {
+        [EV_LEFT_BUTTON]    = FSM_TRANSITION(NULL, yawLeft, FLYING),
+        [EV_RIGHT_BUTTON]   = FSM_TRANSITION(NULL, yawRight, FLYING),
+        [EV_UP_BUTTON]      = FSM_TRANSITION(NULL, altUp, FLYING),
+        [EV_DOWN_BUTTON]    = FSM_TRANSITION(NULL, altDown, FLYING),
+        [EV_LEFT_HELD]      = FSM_TRANSITION(NULL, yawLeft, FLYING),
+        [EV_RIGHT_HELD]     = FSM_TRANSITION(NULL, yawRight, FLYING),
+        [EV_UP_HELD]        = FSM_TRANSITION(NULL, altUp, FLYING),
+        [EV_DOWN_HELD]      = FSM_TRANSITION(NULL, altDown, FLYING),
+        [EV_LEFT_RIGHT_CHORD] = FSM_TRANSITION(NULL, yawHome, FLYING),
+        [EV_UP_DOWN_CHORD]  = FSM_TRANSITION(NULL, startLanding, LANDING),
+        [EV_LAND_REQUEST]   = FSM_TRANSITION(NULL, landFromMinAlt, LANDING),
+        [EV_SWITCH_OFF]     = FSM_TRANSITION(NULL, startLanding, LANDING)
+    },
+    [LANDING] = {
+        [EV_LANDED]         = FSM_TRANSITION(NULL, saveCalibrationRecord, IDLE)
+    },
+    [AUTOTUNE] = {
+        [EV_AUTOTUNE_DONE]  = FSM_TRANSITION(NULL, finishAutotune, LANDING),
+        [EV_AUTOTUNE_FAILED] = FSM_TRANSITION(NULL, abortAutotune, LANDING),
+        [EV_SWITCH_OFF]     = FSM_TRANSITION(NULL, abortAutotune, LANDING)
+    },
+    [SYSID] = {
+        [EV_SYSID_DONE]     = FSM_TRANSITION(NULL, startLanding, LANDING),
+        [EV_SWITCH_OFF]     = FSM_TRANSITION(NULL, abortSysid, LANDING)
+    }
+};
+
+static uint16_t g_flightCounts[NUM_PROGRAM_STATES * NUM_FLIGHT_EVENTS];
+
+/* Dispatch an event to the flight state machine and record the new state, published at the end of the period */
+static void flightDispatch(flightEvent_t event, uint32_t eventTick, uint32_t nowTick) {
+    if (fsmDispatch(&g_flightFsm, event, eventTick, nowTick)) {
+        g_flight.state = (programState)g_flightFsm.state;
+    }
+}
+
+void controlNotify(uint32_t events) {
+    xTaskNotify(g_controlTaskHandle, events, eSetBits);
+}
+
+void controlNotifyFromISR(uint32_t events) {
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    if (g_controlTaskHandle != NULL) {
+        xTaskNotifyFromISR(g_controlTaskHandle, events, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
 static void controlTask (void *pvParameters) {
-    portTickType ui16LastTime;
     uint32_t ui32PollDelay = 10;
-    uint8_t ui8InputEvent;
-    ui16LastTime = xTaskGetTickCount();
+    portTickType ui32TickPeriod = ui32PollDelay / portTICK_RATE_MS;
+    portTickType ui32NextTick;
+    uint32_t ui32Events;
+    inputEvent_t inputEvent;
+    busRead(TOPIC_INPUTS, &g_input);
+    bool prevSystemOn = g_input.system_on;
+    ui32NextTick = xTaskGetTickCount();
+
+    initFsm(&g_flightFsm, &flightTable[0][0], NUM_PROGRAM_STATES, NUM_FLIGHT_EVENTS, IDLE, g_flightCounts, ui32NextTick);
 
     while(1)
     {
-        xQueueReceive(g_InputQueue, &ui8InputEvent, 0);
-            switch(systemStatus.state) {
-                case IDLE: //when current state is Idle state
-                    xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-                    // Obtain mutex semaphore to update the shared resource values
-                    systemStatus.mainPWMDuty = 0;
-                    systemStatus.tailPWMDuty = 0;
-                    xSemaphoreGive(g_StatusMutex);
-                    // Give mutex semaphore after resource update has finished
-                    if(systemStatus.system_on && ui8InputEvent == UP_BUTTON) {
-                    //if the system is on and the up button is pushed
-                        if(!systemStatus.yawCalibrated) {
-                        //if the system yaw was not calibrated, go to calibrate state
-                            systemStatus.state = CALIBRATE;
-                        }
-                        else {
-                        //if the system state was calibrated, go to takeoff state. This is used if the heli has landed and the user wants to takeoff again as yaw will be already calibrated.
-                            systemStatus.state = TAKEOFF;
-                        }
-                    }
-                    break;
-                case CALIBRATE:     //when current state is calibrate
-                    if(systemStatus.system_on) {    //if the system is on
-                        calibrateReferenceAlt();    //calculate the reference altitude
-                        xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-                        systemStatus.tailPWMDuty = 20;
-                        xSemaphoreGive(g_StatusMutex);
-                        if (xSemaphoreTake(g_yawCalibrated) == pdTRUE) {
-                        //if a reference point is just found
-                            systemStatus.currentYaw = 0;  //immediately set the point to 0 as the reference
-                            systemStatus.yawCalibrated = true;  //set yawCalibrated to true
-                            systemStatus.state = TAKEOFF;   //change the state to takeoff
-                        }
-                        break;
-                    }
-                    else {
-                        systemStatus.state = IDLE; // if the system is turned off, change the state to idle
-                    }
-                case TAKEOFF:  //when current state is take off
-                    if(systemStatus.system_on) {
-                        xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-
-                        //set the target yaw and target altitude for the system
-                        systemStatus.targetYaw = 0;
-                        systemStatus.targetAlt = 10;
-                        xSemaphoreGive(g_StatusMutex);
-                        if (systemStatus.currentAltPercent >= 10) {
-                          //when the current altitude is greater then 10
-                            systemStatus.state = FLYING;  //change the system state to flying
-                        }
-                        break;
-                    } else { //if the system is turned off, change the system state to landing
-                        systemStatus.state = LANDING;
-                    }
-                case FLYING:  //when the state is flying
-                    if(systemStatus.system_on) {
-                        switch (ui8InputEvent) {
-                          //take the input from different buttons
-                          //and change the yaw and altitude of the system
-                            xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-                            case LEFT_BUTTON:
-                                systemStatus.targetYaw -= 10;
-                            break;
-                            case RIGHT_BUTTON:
-                                systemStatus.targetYaw += 10;
-                            break;
-                            case UP_BUTTON:
-                                if(systemStatus.targetAlt < 100) {
-                                    systemStatus.targetAlt += 10;
-                                }
-                            break;
-                            case DOWN_BUTTON:
-                                if(systemStatus.targetAlt > 0) {
-                                    systemStatus.targetAlt -= 10;
-                                }
-                            break;
-                            xSemaphoreGive(g_StatusMutex);
-                        }
-                        if(systemStatus.targetAlt < 10) {
-                          //If the target altitude is changed by the user to be below 10, change the state to landing
-                            systemStatus.targetAlt = 10;
-                            systemStatus.state = LANDING;
-                        }
-                        break;
-                    } else {
-                        systemStatus.state = LANDING;
-                    }
-                case LANDING:
-                    systemStatus.targetYaw = 0;
-                    if(abs(systemStatus.currentYawDegrees - systemStatus.targetYaw) < 5) {
-                        systemStatus.targetAlt = 0;
-                        if(systemStatus.currentAltPercent < 1) {
-                            systemStatus.state = IDLE;
-                        }
-                    }
-                    break;
+        // Block until an event source is notified, or the next setpoint tick if this state needs one
+        portTickType ui32Wait = portMAX_DELAY;
+        uint32_t ui32Now = xTaskGetTickCount();
+        if (stateUpdate[g_flightFsm.state] != NULL) {
+            ui32Wait = ((int32_t)(ui32NextTick - ui32Now) > 0) ? ui32NextTick - ui32Now : 0;
+        }
+        if (xTaskNotifyWait(0, UINT32_MAX, &ui32Events, ui32Wait) != pdTRUE) {
+            ui32Events = 0;
+        }
+        ui32Now = xTaskGetTickCount();
+
+        // Snapshot the other tasks' topics once, so the whole wakeup works from consistent values
+        busRead(TOPIC_ALTITUDE, &g_alt);
+        busRead(TOPIC_YAW, &g_yaw);
+        busRead(TOPIC_MAIN_DUTY, &g_mainDuty);
+        busRead(TOPIC_TAIL_DUTY, &g_tailDuty);
+        busRead(TOPIC_INPUTS, &g_input);
+
+        if (ui32Events & CONTROL_EVENT_YAW_CALIBRATED) {
+            g_yawReferenceFound = true;
+        }
+
+        // Input device IDs match the button and chord events, latency is measured from when the input was detected
+        while (xQueueReceive(g_InputQueue, &inputEvent, 0) == pdPASS) {
+            flightDispatch((flightEvent_t)inputEvent.source, inputEvent.tick, ui32Now);
+        }
+
+        // Switch changes are edge events. The inputs topic is only published on a switch change,
+        // so its publish time is when the edge was debounced
+        if (g_input.system_on != prevSystemOn) {
+            prevSystemOn = g_input.system_on;
+            flightDispatch(prevSystemOn ? EV_SWITCH_ON : EV_SWITCH_OFF, ui32Now - busAge(TOPIC_INPUTS, ui32Now), ui32Now);
+        }
+
+        if (stateUpdate[g_flightFsm.state] == NULL) {
+            // No tick needed, start the next one straight away when a state that needs it is entered
+            ui32NextTick = ui32Now;
+        } else if ((int32_t)(ui32Now - ui32NextTick) >= 0) {
+            // Per state update, which can raise an internal event handled in the same period (no latency)
+            flightEvent_t internalEvent = stateUpdate[g_flightFsm.state]();
+            if (internalEvent != EV_NONE) {
+                flightDispatch(internalEvent, ui32Now, ui32Now);
             }
-        // Wait for the required amount of tick, ensure a constant execution frequency
-        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
+
+            // Smooth the setpoints the PID loops track
+            updateSetpoints(ui32PollDelay / 1000.0f);
+
+            ui32NextTick += ui32TickPeriod;
+            if ((int32_t)(ui32Now - ui32NextTick) >= 0) {
+                ui32NextTick = ui32Now + ui32TickPeriod;   //fell behind, don't try to catch up with a burst of ticks
+            }
+        }
+
+        // Publish the new state, targets and setpoints in one update
+        busPublish(TOPIC_STATE, &g_flight);
     }
 }
 /* initialize the control task with set task priority and stack size*/
 uint32_t initControlTask (void) {
+    if (initCalibrationStore() && loadCalibration(&g_calibRecord)) {
+        applyCalibrationGains(&g_calibRecord, &main_rotor, &tail_rotor);
+        g_calibRestored = true;
+        UARTprintf(" Stored calibration loaded \n");
+    }
 
-    if (xTaskCreate (controlTask, (const portCHAR *)"control", 128, NULL, PRIORITY_CONTROL_TASK, NULL) != pdTRUE) {
+    if (xTaskCreate (controlTask, (const portCHAR *)"control", 128, NULL, PRIORITY_CONTROL_TASK, &g_controlTaskHandle) != pdTRUE) {
         return (1);
     }
+    busSubscribe(TOPIC_INPUTS, g_controlTaskHandle, CONTROL_EVENT_SWITCH);
     UARTprintf(" Control initialized \n");
     return (0);
 }
@@ -9,10 +9,63 @@
 #ifndef CONTROL_H_
 #define CONTROL_H_
 
+#include <stdint.h>
+
+// Sources that wake the control task, set as task notification bits
+#define CONTROL_EVENT_INPUT             0x01    // Button event queued on g_InputQueue
+#define CONTROL_EVENT_SWITCH            0x02    // TOPIC_INPUTS published (switch changed)
+#define CONTROL_EVENT_YAW_CALIBRATED    0x04    // Yaw reference slot found
+
+
+/**
+ * @enum            flightEvent.
+ * @brief           Events handled by the flight state machine. Button, chord and held button events share their values with input_device_t.
+*/
+typedef enum _flightEvent {
+    EV_NONE = 0,
+    EV_LEFT_BUTTON,
+    EV_RIGHT_BUTTON,
+    EV_UP_BUTTON,
+    EV_DOWN_BUTTON,
+    EV_UP_DOWN_CHORD,
+    EV_LEFT_RIGHT_CHORD,
+    EV_LEFT_HELD,
+    EV_RIGHT_HELD,
+    EV_UP_HELD,
+    EV_DOWN_HELD,
+    EV_SWITCH_ON,
+    EV_SWITCH_OFF,
+    EV_YAW_CALIBRATED,
+    EV_ALT_REACHED,
+    EV_LAND_REQUEST,
+    EV_LANDED,
+    EV_AUTOTUNE_DONE,
+    EV_AUTOTUNE_FAILED,
+    EV_SYSID_DONE,
+    NUM_FLIGHT_EVENTS
+} flightEvent_t;
+
+
+/**
+ * @function        controlNotify.
+ * @brief           Wake the control task to handle one or more event sources.
+ * @param events    CONTROL_EVENT_ bits to set.
+*/
+void controlNotify(uint32_t events);
+
+
+/**
+ * @function        controlNotifyFromISR.
+ * @brief           Interrupt safe version of controlNotify.
+ * @param events    CONTROL_EVENT_ bits to set.
+*/
+void controlNotifyFromISR(uint32_t events);
+
 
 /**
  * @function            controlTask.
  * @brief               controlTask to be scheduled by FreeRTOS, controls system behaviours based on user input, ADC and yaw readings.
+ *                      Blocks until an event source is notified or, outside IDLE, the next setpoint tick is due.
  * @param pvParameters  Pointer to task parameters (NULL).
 */
 static void controlTask (void *pvParameters);
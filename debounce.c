@@ -0,0 +1,73 @@
+/*
+ * debounce.c
+ *
+ * Parallel (vertical counter) debouncer. All inputs are debounced together with a few
+ * bitwise operations per sample, then long presses, auto repeat and chords are found
+ * from the resulting edge masks.
+ *
+ * Has no FreeRTOS or hardware dependencies.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "debounce.h"
+
+void initDebounce(debounce_t *db, uint32_t state) {
+    db->state = state;
+    db->cnt0 = 0;
+    db->cnt1 = 0;
+    db->holdSamples = 0;
+    db->chordHeld = 0;
+}
+
+void debounceUpdate(debounce_t *db, uint32_t sample, debounceEvents_t *events) {
+    uint8_t i;
+
+    // Count the samples each input has differed from its state, resetting the counts of inputs that agree
+    uint32_t delta = sample ^ db->state;
+    db->cnt1 = (db->cnt1 ^ db->cnt0) & delta;
+    db->cnt0 = ~db->cnt0 & delta;
+
+    // Inputs whose count has wrapped after 4 differing samples change state
+    uint32_t toggle = delta & ~(db->cnt0 | db->cnt1);
+    db->state ^= toggle;
+
+    events->pressed = toggle & db->state;
+    events->released = toggle & ~db->state;
+    events->longPress = 0;
+    events->repeat = 0;
+    events->chord = 0;
+
+    // A press that completes a chord is reported as the chord instead
+    for (i = 0; i < db->numChords; i++) {
+        uint32_t chord = db->chords[i];
+        if ((events->pressed & chord) && (db->state & chord) == chord) {
+            events->chord = chord;
+            events->pressed &= ~chord;
+            db->chordHeld |= chord;
+            break;
+        }
+    }
+    db->chordHeld &= db->state;
+
+    // Held inputs share one timer, which restarts whenever any of them changes
+    uint32_t held = db->state & db->repeatMask & ~db->chordHeld;
+    if ((toggle & db->repeatMask) || held == 0) {
+        db->holdSamples = 0;
+    } else {
+        db->holdSamples++;
+        if (db->holdSamples == db->longSamples) {
+            events->longPress = held;
+        } else if (db->holdSamples == db->longSamples + db->repeatSamples) {
+            events->repeat = held;
+            db->holdSamples = db->longSamples;     //count the next repeat from here
+        }
+    }
+}
+
+bool debounceIdle(const debounce_t *db) {
+    return (db->cnt0 | db->cnt1) == 0 && (db->state & db->repeatMask & ~db->chordHeld) == 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * debounce.h
+ *
+ * Header for debounce.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @struct                  debounce_t.
+ * @brief                   Debouncer for up to 32 inputs packed one per bit, updated together every sample.
+ * @brief                   Each input has a 2 bit counter stored "vertically" across cnt0 / cnt1, so an input has to
+ *                          read differently from its debounced state for 4 samples in a row before it changes.
+ *
+ * @param repeatMask        Inputs that report long presses and auto repeat while held.
+ * @param longSamples       Samples an input must be held for a long press.
+ * @param repeatSamples     Samples between auto repeats after a long press.
+ * @param chords            Input masks reported as a chord when all of the inputs in one are held together.
+ * @param numChords         Number of entries in chords.
+ * @param state             Debounced input levels (1 = active).
+ * @param cnt0              Low bits of the per input counters.
+ * @param cnt1              High bits of the per input counters.
+ * @param holdSamples       Samples since the held repeatMask inputs last changed.
+ * @param chordHeld         Inputs of a completed chord, no long press or repeat until they are released.
+*/
+typedef struct _debounce_t {
+    const uint32_t repeatMask;
+    const uint16_t longSamples;
+    const uint16_t repeatSamples;
+    const uint32_t *chords;
+    const uint8_t numChords;
+    uint32_t state;
+    uint32_t cnt0;
+    uint32_t cnt1;
+    uint16_t holdSamples;
+    uint32_t chordHeld;
+} debounce_t;
+
+
+/**
+ * @struct              debounceEvents_t.
+ * @brief               Input masks of the events found by one debounceUpdate.
+ *
+ * @param pressed       Inputs that became active (not including the press completing a chord).
+ * @param released      Inputs that became inactive.
+ * @param longPress     Inputs held for longSamples.
+ * @param repeat        Inputs due an auto repeat.
+ * @param chord         Chord that was completed, 0 for none.
+*/
+typedef struct _debounceEvents_t {
+    uint32_t pressed;
+    uint32_t released;
+    uint32_t longPress;
+    uint32_t repeat;
+    uint32_t chord;
+} debounceEvents_t;
+
+
+/**
+ * @function        initDebounce.
+ * @brief           Start a debouncer from the current input levels with no events pending.
+ * @param db        Pointer to a debouncer.
+ * @param state     Current input levels.
+*/
+void initDebounce(debounce_t *db, uint32_t state);
+
+
+/**
+ * @function        debounceUpdate.
+ * @brief           Add one sample of every input and find the resulting events.
+ * @param db        Pointer to a debouncer.
+ * @param sample    Raw input levels (1 = active).
+ * @param events    Filled with the events found in this sample.
+*/
+void debounceUpdate(debounce_t *db, uint32_t sample, debounceEvents_t *events);
+
+
+/**
+ * @function        debounceIdle.
+ * @brief           Check whether further samples can only matter after an input changes,
+ *                  i.e. no input is part way through debouncing and nothing is held for a long press or repeat.
+ * @param db        Pointer to a debouncer.
+ * @returns         bool: true if sampling can stop until the next input edge.
+*/
+bool debounceIdle(const debounce_t *db);
+
+#endif /* DEBOUNCE_H_ */
@@ -6,53 +6,247 @@
 */
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
 #include "utils/ustdlib.h"
 #include "display.h"
 #include "OrbitOLED/OrbitOLEDInterface.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOled.h"
+#include "OrbitOLED/lib_OrbitOled/OrbitOledChar.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "bus.h"
+#include "chart.h"
 #include "priorities.h"
 #include "shared.h"
 
-extern systemState systemStatus;
+static xTaskHandle g_flushTaskHandle = NULL;
 
-/*OLEDPrintf function. The variable number of arguments using ... allows this function to print any desired output. */
-void OLEDPrintf (uint8_t charLine, char *format, ...) {
-    char string[17]; // Display fits 16 characters wide.
+#define DISPLAY_LINES   4
+#define DISPLAY_CHARS   16      // Display fits 16 characters wide
+#define DISPLAY_PERIOD_MS   50  // Display task period, also the chart sample period
+
+// Chart columns are the average of this many samples, the full width covers 128 * 2 * 50 ms = 12.8 s
+#define CHART_DECIMATION    2
+#define CHART_ALT_SCALE     2   // Altitude error (%) per pixel
+#define CHART_YAW_SCALE     10  // Yaw error (degrees) per pixel
+
+/**
+ * @struct              displayValues_t.
+ * @brief               The systemState values shown on the display, to tell when a line needs formatting again.
+ *
+ * @param state         Flight state (line 0).
+ * @param alt           Altitude percent (line 1).
+ * @param targetAlt     Target altitude percent (line 1).
+ * @param yaw           Yaw in degrees (line 2).
+ * @param targetYaw     Target yaw in degrees (line 2).
+ * @param systemOn      System on switch (line 3).
+*/
+typedef struct _displayValues_t {
+    programState state;
+    int32_t alt;
+    uint32_t targetAlt;
+    int32_t yaw;
+    int32_t targetYaw;
+    bool systemOn;
+} displayValues_t;
+
+// Characters currently drawn in each cell, '\0' until the cell is first drawn
+static char g_shownText[DISPLAY_LINES][DISPLAY_CHARS];
+static displayValues_t g_shownValues;
+static bool g_valuesShown = false;
+
+// Altitude error above yaw error, under the top text line
+static chart_t g_chart = {
+    .firstPage = 1,
+    .lastPage = 3,
+    .decimation = CHART_DECIMATION,
+    .scales = {CHART_ALT_SCALE, CHART_YAW_SCALE}
+};
+static bool g_chartShown = false;
+
+// Yaw error in degrees, wrapped to -180 to 180
+static int32_t yawError(int32_t yaw, int32_t target) {
+    int32_t error = yaw - target;
+
+    if (error > 180) {
+        error -= 360;
+    } else if (error < -180) {
+        error += 360;
+    }
+    return error;
+}
+/*OLEDPrintf function. The variable number of arguments using ... allows this function to print any desired output.
+  The line is padded with spaces to the display width and only the characters that differ from what is already shown are drawn. */
+uint8_t OLEDPrintf (uint8_t charLine, char *format, ...) {
+    char string[DISPLAY_CHARS + 1];
+    uint8_t i;
+    uint8_t len;
+    uint8_t drawn = 0;
+    bool cursorPlaced = false;
 
     va_list arg;
     va_start(arg, format);
     uvsnprintf (string, sizeof(string), format, arg);
     va_end(arg);
 
-    OLEDStringDraw (string, 0, charLine);
+    for (len = 0; string[len] != '\0'; len++);
+    for (; len < DISPLAY_CHARS; len++) {
+        string[len] = ' ';
+    }
+
+    for (i = 0; i < DISPLAY_CHARS; i++) {
+        if (string[i] == g_shownText[charLine][i]) {
+            cursorPlaced = false;
+            continue;
+        }
+        // A run of changed characters only needs the cursor placing once, drawing moves it along
+        if (!cursorPlaced) {
+            OrbitOledSetCursor(i, charLine);
+            cursorPlaced = true;
+        }
+        OrbitOledPutChar(string[i]);
+        g_shownText[charLine][i] = string[i];
+        drawn++;
+    }
+    return drawn;
+}
+// The four status lines, each only formatted when its values have changed
+static uint8_t printStatusLines(const displayValues_t *values) {
+    uint8_t drawn = 0;
+
+    if (!g_valuesShown || values->state != g_shownValues.state) {
+        drawn += OLEDPrintf(0, "State:%s", statesLookup[values->state]);
+    }
+    if (!g_valuesShown || values->alt != g_shownValues.alt || values->targetAlt != g_shownValues.targetAlt) {
+        drawn += OLEDPrintf(1, "Alt:%02d%% [%02d%%]", values->alt, values->targetAlt);
+    }
+    if (!g_valuesShown || values->yaw != g_shownValues.yaw || values->targetYaw != g_shownValues.targetYaw) {
+        drawn += OLEDPrintf(2, "Yaw:%4d`[%4d`]", values->yaw, values->targetYaw);
+    }
+    if (!g_valuesShown || values->systemOn != g_shownValues.systemOn) {
+        drawn += OLEDPrintf(3, "System on: %s", values->systemOn ? "YES" : "NO");
+    }
+    return drawn;
 }
 /* set up what to print in the OLED
 line 1: state of the system
 line 2: altitude of the system
 line 3: yaw of the system
-line 4: if the system is on or not */
-void oledPrintStatus(void) {
-    OLEDPrintf(0, "State:%s                ", statesLookup[systemStatus.state]);
-    OLEDPrintf(1, "Alt:%02d%% [%02d%%]", systemStatus.currentAltPercent, systemStatus.targetAlt);
-    OLEDPrintf(2, "Yaw:%03d` [%03d`]", systemStatus.currentYawDegrees, systemStatus.targetYaw);
-    OLEDPrintf(3, "System on: %s                ", systemStatus.system_on ? "YES" : "NO");
+line 4: if the system is on or not
+With the chart shown only line 1 is text, giving current and target altitude and yaw.
+Lines are only formatted when the values shown on them have changed. */
+bool oledPrintStatus(const systemState *status, bool chart) {
+    displayValues_t values;
+    uint8_t drawn = 0;
+
+    values.state = status->flight.state;
+    values.alt = status->alt.currentAltPercent;
+    values.targetAlt = status->flight.targetAlt;
+    values.yaw = status->yaw.currentYawDegrees;
+    values.targetYaw = status->flight.targetYaw;
+    values.systemOn = status->input.system_on;
+
+    if (chart) {
+        if (!g_valuesShown || values.alt != g_shownValues.alt || values.targetAlt != g_shownValues.targetAlt
+                || values.yaw != g_shownValues.yaw || values.targetYaw != g_shownValues.targetYaw) {
+            drawn += OLEDPrintf(0, "A%02d>%02d Y%d>%d", values.alt, values.targetAlt, values.yaw, values.targetYaw);
+        }
+    } else {
+        drawn += printStatusLines(&values);
+    }
+
+    g_shownValues = values;
+    g_valuesShown = true;
+    return drawn != 0;
 }
+/* Sample the chart every period in flight, and show it instead of the status lines while flying.
+   Returns true if anything was drawn. */
+static bool displayChart(const systemState *status, bool *chart) {
+    bool inFlight = isFlightState(status->flight.state);
+    bool newColumn = false;
+    int32_t values[CHART_TRACES];
+
+    if (inFlight) {
+        values[0] = status->alt.currentAltPercent - (int32_t)status->flight.targetAlt;
+        values[1] = yawError(status->yaw.currentYawDegrees, status->flight.targetYaw);
+        newColumn = chartSample(&g_chart, values);
+    } else {
+        chartReset(&g_chart);
+    }
+
+    *chart = (status->flight.state == FLYING);
+    if (*chart != g_chartShown) {
+        // Every line is drawn over by the page change, so nothing on screen can be skipped
+        memset(g_shownText, 0, sizeof(g_shownText));
+        g_valuesShown = false;
+        g_chartShown = *chart;
+        if (*chart) {
+            chartDraw(&g_chart);
+        }
+        return *chart;
+    }
+
+    if (*chart && newColumn) {
+        chartScroll(&g_chart);
+        return true;
+    }
+    return false;
+}
+#if defined(ORBITOLED_UDMA)
+// Called from the SSI3 interrupt once the front buffer has been sent
+static void displayUpdateDone(void) {
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(g_flushTaskHandle, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#endif
+
 /* set up the display task.*/
 static void displayTask (void *pvParameters) {
     portTickType ui16LastTime;
-    uint32_t ui32PollDelay = 250;
+    systemState status;
+    bool chart;
+    bool framePending = false;
     ui16LastTime = xTaskGetTickCount();
 
+    // Draw all the lines then send the changes once, rather than after every line
+    OrbitOledSetCharUpdate(0);
+
     while(1) {
         //print status on the OLED
-        oledPrintStatus();
+        readSystemState(&status);
+        framePending |= displayChart(&status, &chart);
+        framePending |= oledPrintStatus(&status, chart);
+
+        /* Hand the changes to the flush task. If it is still sending the last frame they're kept
+           for the next one, the back buffer can always be drawn into so this never waits on SPI */
+        if (framePending && OrbitOledPresent()) {
+            framePending = false;
+            xTaskNotifyGive(g_flushTaskHandle);
+        }
         // Wait for the required amount of tick, ensure a constant execution frequency
-        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
+        vTaskDelayUntil(&ui16LastTime, DISPLAY_PERIOD_MS / portTICK_RATE_MS);
+    }
+}
+/* Sends the front buffer to the display whenever the display task presents a new frame.
+   Runs below everything else so the SPI transfer only uses otherwise idle time. */
+static void displayFlushTask (void *pvParameters) {
+    while(1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        OrbitOledFlush();
+
+        // With uDMA the flush carries on in the background, wait for it so the next notify is a new frame
+        while (OrbitOledUpdateBusy()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
     }
 }
 /* initialize the display task with set task priority and stack size*/
@@ -62,6 +256,16 @@ uint32_t initDisplayTask(void) {
         return(1);
     }
 
+    if(xTaskCreate(displayFlushTask, (const portCHAR *)"Flush", 128, NULL, PRIORITY_DISPLAY_FLUSH_TASK, &g_flushTaskHandle) != pdTRUE) {
+        return(1);
+    }
+
+#if defined(ORBITOLED_UDMA)
+    // The completion callback uses the FreeRTOS API so must be at or below configMAX_SYSCALL_INTERRUPT_PRIORITY
+    IntPrioritySet(INT_SSI3, configKERNEL_INTERRUPT_PRIORITY);
+    OrbitOledSetUpdateDone(displayUpdateDone);
+#endif
+
     UARTprintf(" UART initialized \n");
     return(0);
 }
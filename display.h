@@ -11,22 +11,32 @@
 #ifndef DISPLAY_H_
 #define DISPLAY_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shared.h"
+
 
 /**
  * @function        OLEDPrintf.
- * @brief           Print to Tiva OLED display.
+ * @brief           Print to Tiva OLED display, padded with spaces to the full line.
+ * @brief           Only characters that differ from those already on the line are drawn.
  * @param charLine  Line of the display to print on.
  * @param format    Format string to be printed.
  * @param ...       va_list of values to insert into format string.
+ * @returns         uint8_t: Number of characters drawn.
 */
-void OLEDPrintf (uint8_t charLine, char *format, ...);
+uint8_t OLEDPrintf (uint8_t charLine, char *format, ...);
 
 
 /**
  * @function        oledPrintStatus.
- * @brief           Print status information to Tiva OLED display.
+ * @brief           Print status information to Tiva OLED display, formatting only the lines whose values have changed.
+ * @param status    System state snapshot to show.
+ * @param chart     The strip chart is shown below the top line, so only print the top line.
+ * @returns         bool: true if anything was drawn, else false.
 */
-void oledPrintStatus(void);
+bool oledPrintStatus(const systemState *status, bool chart);
 
 
 /**
@@ -0,0 +1,32 @@
+/*
+ * dma.c
+ *
+ * uDMA controller set up. The controller has one channel control table shared by
+ * every peripheral using uDMA, so it is owned here rather than by any one driver.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+
+#include "dma.h"
+
+// Channel control table, the controller requires it to be 1024 byte aligned
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(g_dmaControlTable, 1024)
+static uint8_t g_dmaControlTable[1024];
+#else
+static uint8_t g_dmaControlTable[1024] __attribute__ ((aligned(1024)));
+#endif
+
+void initDMA(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(g_dmaControlTable);
+}
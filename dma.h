@@ -0,0 +1,19 @@
+/*
+ * dma.h
+ *
+ * Header for dma.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef DMA_H_
+#define DMA_H_
+
+/**
+ * @function        initDMA.
+ * @brief           Enable the uDMA controller and give it the channel control table shared by every uDMA user.
+ * @brief           Must be called before any peripheral sets up a uDMA channel.
+*/
+void initDMA(void);
+
+#endif /* DMA_H_ */
@@ -0,0 +1,23 @@
+/**
+ * feedforward.c
+ *
+ * Main rotor to tail rotor torque feedforward
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include "feedforward.h"
+
+float torqueFeedforward(float mainDuty, float period, feedforward_struct *ffObj) {
+    float rawRate = (mainDuty - ffObj->prev_main) / period;
+
+    ffObj->prev_main = mainDuty;
+    ffObj->rate += ffObj->rate_alpha * (rawRate - ffObj->rate);
+
+    return ffObj->Kbias + ffObj->Kmain * mainDuty + ffObj->Krate * ffObj->rate;
+}
+
+void resetFeedforward(float mainDuty, feedforward_struct *ffObj) {
+    ffObj->prev_main = mainDuty;
+    ffObj->rate = 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * feedforward.h
+ *
+ * Header for feedforward.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef FEEDFORWARD_H_
+#define FEEDFORWARD_H_
+
+#include <stdint.h>
+
+/**
+ * @struct              feedforward_struct.
+ * @brief               Main rotor to tail rotor reaction torque feedforward.
+ * @brief               Tail offset = Kbias + Kmain * mainDuty + Krate * d(mainDuty)/dt, with the rate low pass filtered.
+ * @brief               Coefficients are found by a least squares fit of logged tail duty against main duty and its rate
+ *                      over flights with a constant yaw target, so the tail PID only has to correct what is left.
+ *
+ * @param Kbias         Constant tail duty offset (%).
+ * @param Kmain         Tail duty per main duty (% / %).
+ * @param Krate         Tail duty per main duty rate (% / (%/s)).
+ * @param rate_alpha    Low pass filter coefficient for the main duty rate (0 - 1, 1 = unfiltered).
+ * @param prev_main     Main duty at the last update.
+ * @param rate          Filtered main duty rate (%/s).
+*/
+typedef struct _feedforward_struct {
+    float Kbias;
+    float Kmain;
+    float Krate;
+    const float rate_alpha;
+    float prev_main;
+    float rate;
+} feedforward_struct;
+
+
+/**
+ * @function        torqueFeedforward.
+ * @brief           Calculate the tail duty offset that cancels the main rotor reaction torque.
+ * @param mainDuty  Current main rotor duty (%).
+ * @param period    Change in time since last update.
+ * @param ffObj     Pointer to a feedforward structure.
+ * @returns         float: Tail duty offset (%) to add to the tail PID output.
+*/
+float torqueFeedforward(float mainDuty, float period, feedforward_struct *ffObj);
+
+
+/**
+ * @function        resetFeedforward.
+ * @brief           Clear the rate history, e.g. when the rotors are switched off.
+ * @param mainDuty  Current main rotor duty (%).
+ * @param ffObj     Pointer to a feedforward structure.
+*/
+void resetFeedforward(float mainDuty, feedforward_struct *ffObj);
+
+#endif /* FEEDFORWARD_H_ */
@@ -0,0 +1,76 @@
+/*
+ * fsm.c
+ *
+ * Table driven state machine. Each event costs one table lookup, an optional guard
+ * and an optional action, independent of the number of states.
+ *
+ * Has no FreeRTOS or hardware dependencies so transition tables can be tested on their own.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fsm.h"
+
+void initFsm(fsm_t *fsm, const fsmTransition_t *table, uint8_t numStates, uint8_t numEvents, uint8_t initialState, uint16_t *counts, uint32_t nowTick) {
+    uint32_t i;
+
+    fsm->table = table;
+    fsm->numStates = numStates;
+    fsm->numEvents = numEvents;
+    fsm->state = initialState;
+    fsm->stateEnteredTick = nowTick;
+    fsm->transitions = 0;
+    fsm->ignored = 0;
+    fsm->lastLatency = 0;
+    fsm->maxLatency = 0;
+    fsm->counts = counts;
+
+    if (counts != NULL) {
+        for (i = 0; i < (uint32_t)numStates * numEvents; i++) {
+            counts[i] = 0;
+        }
+    }
+}
+
+bool fsmDispatch(fsm_t *fsm, uint8_t event, uint32_t eventTick, uint32_t nowTick) {
+    if (fsm->state >= fsm->numStates || event >= fsm->numEvents) {
+        fsm->ignored++;
+        return false;
+    }
+
+    uint32_t cell = (uint32_t)fsm->state * fsm->numEvents + event;
+    const fsmTransition_t *transition = &fsm->table[cell];
+
+    if (!transition->defined || (transition->guard != NULL && !transition->guard())) {
+        fsm->ignored++;
+        return false;
+    }
+
+    if (transition->action != NULL) {
+        transition->action();
+    }
+
+    // Self transitions (e.g. changing a setpoint) don't restart the time in state
+    if (transition->next != fsm->state) {
+        fsm->state = transition->next;
+        fsm->stateEnteredTick = nowTick;
+    }
+
+    fsm->transitions++;
+    fsm->lastLatency = nowTick - eventTick;
+    if (fsm->lastLatency > fsm->maxLatency) {
+        fsm->maxLatency = fsm->lastLatency;
+    }
+    if (fsm->counts != NULL && fsm->counts[cell] < UINT16_MAX) {
+        fsm->counts[cell]++;
+    }
+    return true;
+}
+
+uint32_t fsmTimeInState(const fsm_t *fsm, uint32_t nowTick) {
+    return nowTick - fsm->stateEnteredTick;
+}
@@ -0,0 +1,113 @@
+/*
+ * fsm.h
+ *
+ * Header for fsm.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef FSM_H_
+#define FSM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @typedef         fsmGuard_t.
+ * @brief           Transition guard, the transition is only taken if the guard returns true.
+*/
+typedef bool (*fsmGuard_t)(void);
+
+
+/**
+ * @typedef         fsmAction_t.
+ * @brief           Transition action, run once when the transition is taken.
+*/
+typedef void (*fsmAction_t)(void);
+
+
+/**
+ * @struct          fsmTransition_t.
+ * @brief           One cell of a state x event transition table. Cells left zeroed ignore the event.
+ *
+ * @param defined   Cell holds a transition (set by FSM_TRANSITION).
+ * @param guard     Guard function, NULL to always take the transition.
+ * @param action    Action function, NULL for no action.
+ * @param next      State to move to.
+*/
+typedef struct _fsmTransition_t {
+    bool defined;
+    fsmGuard_t guard;
+    fsmAction_t action;
+    uint8_t next;
+} fsmTransition_t;
+
+// Initialiser for a transition table cell
+#define FSM_TRANSITION(guard, action, next)     { true, (guard), (action), (next) }
+
+
+/**
+ * @struct                  fsm_t.
+ * @brief                   Table driven state machine with transition timing counters.
+ *
+ * @param table             Transition table, numStates rows of numEvents cells.
+ * @param numStates         Number of rows in the table.
+ * @param numEvents         Number of columns in the table.
+ * @param state             Current state.
+ * @param stateEnteredTick  Tick count when the current state was entered.
+ * @param transitions       Number of transitions taken.
+ * @param ignored           Number of events with no transition or a failed guard.
+ * @param lastLatency       Ticks from the last event being generated to its transition being taken.
+ * @param maxLatency        Largest lastLatency seen.
+ * @param counts            Optional numStates x numEvents array counting each transition taken (NULL to disable).
+*/
+typedef struct _fsm_t {
+    const fsmTransition_t *table;
+    uint8_t numStates;
+    uint8_t numEvents;
+    uint8_t state;
+    uint32_t stateEnteredTick;
+    uint32_t transitions;
+    uint32_t ignored;
+    uint32_t lastLatency;
+    uint32_t maxLatency;
+    uint16_t *counts;
+} fsm_t;
+
+
+/**
+ * @function            initFsm.
+ * @brief               Initialize a state machine and clear its counters.
+ * @param fsm           Pointer to the state machine.
+ * @param table         Transition table, numStates x numEvents cells.
+ * @param numStates     Number of states.
+ * @param numEvents     Number of events.
+ * @param initialState  Starting state.
+ * @param counts        Optional numStates x numEvents array for transition counts (NULL to disable).
+ * @param nowTick       Current tick count.
+*/
+void initFsm(fsm_t *fsm, const fsmTransition_t *table, uint8_t numStates, uint8_t numEvents, uint8_t initialState, uint16_t *counts, uint32_t nowTick);
+
+
+/**
+ * @function            fsmDispatch.
+ * @brief               Look up the transition for the current state and event, check its guard and take it.
+ * @param fsm           Pointer to the state machine.
+ * @param event         Event to dispatch.
+ * @param eventTick     Tick count when the event was generated (used for latency).
+ * @param nowTick       Current tick count.
+ * @returns             bool: true if a transition was taken, else false.
+*/
+bool fsmDispatch(fsm_t *fsm, uint8_t event, uint32_t eventTick, uint32_t nowTick);
+
+
+/**
+ * @function            fsmTimeInState.
+ * @brief               Ticks spent in the current state.
+ * @param fsm           Pointer to the state machine.
+ * @param nowTick       Current tick count.
+ * @returns             uint32_t: Ticks since the current state was entered.
+*/
+uint32_t fsmTimeInState(const fsm_t *fsm, uint32_t nowTick);
+
+#endif /* FSM_H_ */
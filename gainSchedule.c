@@ -0,0 +1,84 @@
+/*
+ * gainSchedule.c
+ *
+ * Altitude scheduled PID gains. Gain multipliers are given at a few altitude
+ * breakpoints per profile and linearly interpolated by the compiler into a
+ * row per altitude percent, so scheduling at runtime is a single table lookup.
+ *
+ * The multipliers scale the gains in main_rotor / tail_rotor (1.0 = tuned gains),
+ * so gains restored from EEPROM or found by tuning keep their meaning.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+
+#include "gainSchedule.h"
+#include "pid.h"
+#include "shared.h"
+
+/* Breakpoints: gain multiplier at 0%, 10%, 30% and 100% altitude */
+// Main rotor, TAKEOFF / LANDING
+#define MAIN_GROUND_KP  (0.4f, 0.6f, 0.8f, 0.9f)
+#define MAIN_GROUND_KI  (0.2f, 0.5f, 0.8f, 0.9f)
+#define MAIN_GROUND_KD  (0.4f, 0.6f, 0.8f, 0.9f)
+// Main rotor, FLYING
+#define MAIN_CRUISE_KP  (0.6f, 0.8f, 1.0f, 1.0f)
+#define MAIN_CRUISE_KI  (0.4f, 0.7f, 1.0f, 1.0f)
+#define MAIN_CRUISE_KD  (0.6f, 0.8f, 1.0f, 1.0f)
+// Tail rotor, TAKEOFF / LANDING
+#define TAIL_GROUND_KP  (0.6f, 0.7f, 0.9f, 0.9f)
+#define TAIL_GROUND_KI  (0.3f, 0.6f, 0.9f, 0.9f)
+#define TAIL_GROUND_KD  (0.6f, 0.7f, 0.9f, 0.9f)
+// Tail rotor, FLYING
+#define TAIL_CRUISE_KP  (0.8f, 0.9f, 1.0f, 1.0f)
+#define TAIL_CRUISE_KI  (0.6f, 0.8f, 1.0f, 1.0f)
+#define TAIL_CRUISE_KD  (0.8f, 0.9f, 1.0f, 1.0f)
+
+// Linear interpolation between breakpoints, a constant expression for constant alt
+#define SCHED_LERP(alt, a0, a1, g0, g1)     ((g0) + ((g1) - (g0)) * (float)((alt) - (a0)) / (float)((a1) - (a0)))
+#define SCHED_INTERP_(alt, g0, g10, g30, g100) \
+    ((alt) < 10 ? SCHED_LERP(alt, 0, 10, g0, g10) : \
+     (alt) < 30 ? SCHED_LERP(alt, 10, 30, g10, g30) : \
+                  SCHED_LERP(alt, 30, 100, g30, g100))
+#define SCHED_UNPACK(...)                   __VA_ARGS__
+#define SCHED_CALL(macro, args)             macro args
+#define SCHED_INTERP(alt, points)           SCHED_CALL(SCHED_INTERP_, (alt, SCHED_UNPACK points))
+
+// Table rows
+#define SCHED_ROW(alt, KP, KI, KD)          { SCHED_INTERP(alt, KP), SCHED_INTERP(alt, KI), SCHED_INTERP(alt, KD) }
+#define SCHED_ROWS10(base, KP, KI, KD) \
+    SCHED_ROW((base) + 0, KP, KI, KD), SCHED_ROW((base) + 1, KP, KI, KD), \
+    SCHED_ROW((base) + 2, KP, KI, KD), SCHED_ROW((base) + 3, KP, KI, KD), \
+    SCHED_ROW((base) + 4, KP, KI, KD), SCHED_ROW((base) + 5, KP, KI, KD), \
+    SCHED_ROW((base) + 6, KP, KI, KD), SCHED_ROW((base) + 7, KP, KI, KD), \
+    SCHED_ROW((base) + 8, KP, KI, KD), SCHED_ROW((base) + 9, KP, KI, KD)
+#define SCHED_TABLE(KP, KI, KD) { \
+    SCHED_ROWS10(0, KP, KI, KD),  SCHED_ROWS10(10, KP, KI, KD), \
+    SCHED_ROWS10(20, KP, KI, KD), SCHED_ROWS10(30, KP, KI, KD), \
+    SCHED_ROWS10(40, KP, KI, KD), SCHED_ROWS10(50, KP, KI, KD), \
+    SCHED_ROWS10(60, KP, KI, KD), SCHED_ROWS10(70, KP, KI, KD), \
+    SCHED_ROWS10(80, KP, KI, KD), SCHED_ROWS10(90, KP, KI, KD), \
+    SCHED_ROW(100, KP, KI, KD) }
+
+static const pid_gain_scale mainSchedule[NUM_SCHED_PROFILES][SCHED_ALT_ENTRIES] = {
+    [SCHED_GROUND] = SCHED_TABLE(MAIN_GROUND_KP, MAIN_GROUND_KI, MAIN_GROUND_KD),
+    [SCHED_CRUISE] = SCHED_TABLE(MAIN_CRUISE_KP, MAIN_CRUISE_KI, MAIN_CRUISE_KD)
+};
+
+static const pid_gain_scale tailSchedule[NUM_SCHED_PROFILES][SCHED_ALT_ENTRIES] = {
+    [SCHED_GROUND] = SCHED_TABLE(TAIL_GROUND_KP, TAIL_GROUND_KI, TAIL_GROUND_KD),
+    [SCHED_CRUISE] = SCHED_TABLE(TAIL_CRUISE_KP, TAIL_CRUISE_KI, TAIL_CRUISE_KD)
+};
+
+void scheduleGains(int32_t altPercent, programState state, pid_struct *mainPid, pid_struct *tailPid) {
+    scheduleProfile_t profile = (state == FLYING || state == AUTOTUNE || state == SYSID) ? SCHED_CRUISE : SCHED_GROUND;
+
+    if (altPercent < 0) {
+        altPercent = 0;
+    } else if (altPercent > SCHED_ALT_ENTRIES - 1) {
+        altPercent = SCHED_ALT_ENTRIES - 1;
+    }
+    mainPid->scale = &mainSchedule[profile][altPercent];
+    tailPid->scale = &tailSchedule[profile][altPercent];
+}
@@ -0,0 +1,41 @@
+/*
+ * gainSchedule.h
+ *
+ * Header for gainSchedule.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef GAINSCHEDULE_H_
+#define GAINSCHEDULE_H_
+
+#include <stdint.h>
+
+#include "pid.h"
+#include "shared.h"
+
+#define SCHED_ALT_ENTRIES   101     // One table row per altitude percent, 0 - 100
+
+
+/**
+ * @enum            scheduleProfile.
+ * @brief           Gain profiles, selected from the flight state.
+*/
+typedef enum _scheduleProfile {
+    SCHED_GROUND = 0,   // TAKEOFF / LANDING, gentle gains while in ground effect
+    SCHED_CRUISE,       // FLYING / AUTOTUNE / SYSID, full tuned gains once clear of the ground
+    NUM_SCHED_PROFILES
+} scheduleProfile_t;
+
+
+/**
+ * @function        scheduleGains.
+ * @brief           Point the main and tail PID gain scales at the table rows for the current altitude and flight state.
+ * @param altPercent Current altitude percentage (clamped to 0 - 100).
+ * @param state     Current flight state.
+ * @param mainPid   Pointer to the main rotor PID structure.
+ * @param tailPid   Pointer to the tail rotor PID structure.
+*/
+void scheduleGains(int32_t altPercent, programState state, pid_struct *mainPid, pid_struct *tailPid);
+
+#endif /* GAINSCHEDULE_H_ */
@@ -24,58 +24,111 @@
 #include "semphr.h"
 #include "task.h"
 
+#include "adc.h"
+#include "autotune.h"
+#include "bus.h"
 #include "control.h"
+#include "gainSchedule.h"
 #include "userInputs.h"
 #include "pid.h"
 #include "height.h"
 #include "priorities.h"
+#include "sysid.h"
 #include "pwm.h"
 #include "shared.h"
+#include "stateFeedback.h"
 
-extern systemState systemStatus;
+#define HEIGHT_PERIOD_S     (ADC_PERIOD_MS / 1000.0f)  // Control period, the task runs on every ADC sample
+#define HEIGHT_PID_PERIOD_S 0.01f   // Period the main PID gains were hand tuned with, kept so they are not retuned
+
+#define HEIGHT_SYSID_STEPS  (SYSID_MAIN_PERIOD_MS / ADC_PERIOD_MS)    // Height steps per logged identification sample
 
 extern pid_struct main_rotor;
+extern pid_struct tail_rotor;
+
+extern controller_t g_mainController;
+extern sf_struct main_state_feedback;
 
-extern xQueueHandle g_ADCQueue;
+/* Log one height step (the duty applied and the altitude it was computed from) for a main rotor identification run */
+static void logSysidMain(uint8_t ui8MainDuty, int32_t alt) {
+    uint8_t ui8TailDuty;
+    yawStatus_t yaw;
 
-extern xSemaphoreHandle g_StatusMutex;
+    busRead(TOPIC_TAIL_DUTY, &ui8TailDuty);
+    busRead(TOPIC_YAW, &yaw);
+    sysidLog(xTaskGetTickCount() * portTICK_RATE_MS, ui8MainDuty, ui8TailDuty, alt, yaw.currentYawDegrees);
+}
 
 static void heightTask (void *pvParameters) {
 
   //set up parameters
-    portTickType ui16LastTime;
     uint32_t ui32ADCInput;
-    uint32_t ui32PollDelay = 3;
-    ui16LastTime = xTaskGetTickCount();
+    uint8_t ui8MainDuty = 0;
+    altStatus_t alt = {0};
+    flightStatus_t flight;
+    bool bControlling = false;
+    uint32_t ui32SysidStep = 0;
 
     while (1) {
-        if (xQueueReceive(g_ADCQueue, &ui32ADCInput, 0) == pdPASS) {
-            xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Wait for the ADC task to publish a new sample, runs at the ADC rate
+        busRead(TOPIC_ADC, &ui32ADCInput);
+        busRead(TOPIC_STATE, &flight);
+
+        if (isFlightState(flight.state)) {
             //Calculate current Altitude
-            systemStatus.currentAlt = systemStatus.referenceAlt - ui32ADCInput;
+            alt.currentAlt = flight.referenceAlt - ui32ADCInput;
         
             /* Calculate the current altitude percentage. 
             Overall calculation done here is (currentAlt * (4/5)) / 8, 
             so at minimum height this would be 0 / 8 = 0 and at maximum 
             height this would be 800 / 8 = 100, giving the range of 0-100% */
-            systemStatus.currentAltPercent = (systemStatus.currentAlt * ((4 << 8) / 5)) >> 11;
-            
+            alt.currentAltPercent = (alt.currentAlt * ((4 << 8) / 5)) >> 11;
+            busPublish(TOPIC_ALTITUDE, &alt);
 
-            systemStatus.mainPWMDuty = pid(systemStatus.currentAltPercent, systemStatus.targetAlt, 0.01, &main_rotor);
-            //change the main PWM duty cycle using the pid function
+            scheduleGains(alt.currentAltPercent, flight.state, &main_rotor, &tail_rotor);
+            //select the gains for the current altitude band and flight state
 
-            xSemaphoreGive(g_StatusMutex);
+            if (!bControlling) {
+                resetStateFeedback(alt.currentAltPercent, &main_state_feedback);
+                bControlling = true;
+                //start the state feedback integral and rate estimate from rest on the first sample of a flight
+            }
+
+            if (!autotuneMainDuty(alt.currentAltPercent, xTaskGetTickCount() * portTICK_RATE_MS, &ui8MainDuty)) {
+                float excitation = sysidExcitation(SYSID_MAIN, xTaskGetTickCount() * portTICK_RATE_MS);
+                if (g_mainController == CTRL_STATE_FEEDBACK) {
+                    ui8MainDuty = stateFeedback(alt.currentAltPercent, flight.refAlt, excitation, HEIGHT_PERIOD_S, &main_state_feedback);
+                } else {
+                    ui8MainDuty = pidFeedforward(alt.currentAltPercent, flight.refAlt, excitation, HEIGHT_PID_PERIOD_S, &main_rotor);
+                }
+                //change the main PWM duty cycle using the selected controller (plus any identification excitation), unless the autotune relay is driving it
+            }
+            busPublish(TOPIC_MAIN_DUTY, &ui8MainDuty);
+
+            if (!sysidLogging(SYSID_MAIN)) {
+                ui32SysidStep = 0;
+            } else if (ui32SysidStep++ % HEIGHT_SYSID_STEPS == 0) {
+                logSysidMain(ui8MainDuty, alt.currentAltPercent);
+                //log every HEIGHT_SYSID_STEPS steps while the main rotor is being identified, in step with its excitation
+            }
+        } else if (bControlling) {
+            //landed, turn the main rotor command off
+            bControlling = false;
+            ui8MainDuty = 0;
+            busPublish(TOPIC_MAIN_DUTY, &ui8MainDuty);
         }
-        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
-        // Wait for the required amount of tick, ensure a constant execution frequency
     }
 }
 /* initialize the height task with set task priority and stack size*/
 uint32_t initHeightTask (void) {
 
-    if (xTaskCreate (heightTask, (const portCHAR *)"Height", 128, NULL, PRIORITY_HEIGHT_TASK, NULL) != pdTRUE) {
+    xTaskHandle heightHandle;
+
+    if (xTaskCreate (heightTask, (const portCHAR *)"Height", 128, NULL, PRIORITY_HEIGHT_TASK, &heightHandle) != pdTRUE) {
         return (1);
     }
+    busSubscribe(TOPIC_ADC, heightHandle, BUS_NOTIFY_UPDATED);
     UARTprintf(" Height controls initialized \n");
     return (0);
 }
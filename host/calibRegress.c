@@ -0,0 +1,96 @@
+/*
+ * calibRegress.c
+ *
+ * Host regression for the calibration record (calibration.c built with
+ * HOST_BUILD, which keeps the record in CALIB_HOST_FILE instead of EEPROM).
+ * Checks the CRC against the standard check value, that a saved record loads
+ * back unchanged with its gains, and that a missing file, a wrong magic or
+ * version, and a single flipped bit anywhere in the record are all rejected.
+ *
+ *     make -C host check
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "calibration.h"
+#include "pid.h"
+
+static int g_failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+static bool writeRaw(const calibRecord_t *record) {
+    FILE *file = fopen(CALIB_HOST_FILE, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t written = fwrite(record, sizeof(calibRecord_t), 1, file);
+    fclose(file);
+    return written == 1;
+}
+
+int main(void) {
+    pid_struct mainPid = {.Kp = 1, .Ki = 0.45f, .Kd = 1, .output_min = 2, .output_max = 98};
+    pid_struct tailPid = {.Kp = 0.8f, .Ki = 0.2f, .Kd = 0.5f, .output_min = 2, .output_max = 98};
+    pid_struct mainLoaded = {.output_min = 2, .output_max = 98};
+    pid_struct tailLoaded = {.output_min = 2, .output_max = 98};
+    calibRecord_t saved = {0};
+    calibRecord_t loaded;
+    calibRecord_t corrupt;
+    uint32_t bit;
+    uint32_t rejected = 0;
+
+    expect(calibCrc32((const uint8_t *)"123456789", 9) == 0xCBF43926, "CRC-32 check value");
+
+    remove(CALIB_HOST_FILE);
+    expect(initCalibrationStore(), "store initialises");
+    expect(!loadCalibration(&loaded), "missing file is rejected");
+
+    saved.referenceAlt = 1234;
+    saved.yawOffset = -300;
+    storeCalibrationGains(&saved, &mainPid, &tailPid);
+    expect(saveCalibration(&saved), "record saves");
+    expect(loadCalibration(&loaded), "saved record loads");
+    expect(memcmp(&saved, &loaded, sizeof(calibRecord_t)) == 0, "record loads back unchanged");
+
+    applyCalibrationGains(&loaded, &mainLoaded, &tailLoaded);
+    expect(mainLoaded.Kp == mainPid.Kp && mainLoaded.Ki == mainPid.Ki && mainLoaded.Kd == mainPid.Kd,
+           "main gains round trip");
+    expect(tailLoaded.Kp == tailPid.Kp && tailLoaded.Ki == tailPid.Ki && tailLoaded.Kd == tailPid.Kd,
+           "tail gains round trip");
+
+    corrupt = saved;
+    corrupt.magic ^= 1;
+    corrupt.crc = calibCrc32((const uint8_t *)&corrupt, offsetof(calibRecord_t, crc));
+    expect(writeRaw(&corrupt) && !loadCalibration(&loaded), "wrong magic is rejected");
+
+    corrupt = saved;
+    corrupt.version = CALIB_VERSION + 1;
+    corrupt.crc = calibCrc32((const uint8_t *)&corrupt, offsetof(calibRecord_t, crc));
+    expect(writeRaw(&corrupt) && !loadCalibration(&loaded), "other version is rejected");
+
+    for (bit = 0; bit < sizeof(calibRecord_t) * 8; bit++) {
+        corrupt = saved;
+        ((uint8_t *)&corrupt)[bit / 8] ^= 1 << (bit % 8);
+        if (writeRaw(&corrupt) && !loadCalibration(&loaded)) {
+            rejected++;
+        }
+    }
+    expect(rejected == sizeof(calibRecord_t) * 8, "every single bit error is rejected");
+
+    remove(CALIB_HOST_FILE);
+    printf("calibration record: %u of %u bit errors rejected, %d failures\n",
+           (unsigned)rejected, (unsigned)(sizeof(calibRecord_t) * 8), g_failures);
+    return g_failures != 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * oledBench.c
+ *
+ * Host benchmark of glyphs per second drawn into the OLED buffer. Font glyphs
+ * are put with OrbitOledPutBmp on character cells, which takes the byte aligned
+ * fast path, and three rows down, which takes the shifted raster op path. Text
+ * through OrbitOledPutChar is timed as well. Each rate is the best of several
+ * runs.
+ *
+ * Built twice, oledBenchRop with ORBITOLED_NO_FAST_BMP so the aligned glyphs go
+ * through the raster op as they did before the fast path. The buffer checksums
+ * printed by the two builds must match.
+ *
+ *     make -C host bench
+ *     host/oledBench [glyphs]
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "OrbitOled.h"
+#include "OrbitOledChar.h"
+#include "OrbitOledGrph.h"
+
+#define BENCH_GLYPHS        2000000
+#define BENCH_REPEATS       5       // Best of, to ride out the rest of the host
+#define BENCH_FIRST_CHAR    ' '
+#define BENCH_CHARS         95      // Printable ASCII
+
+// Owned by OrbitOled.c, the frame being drawn and the current font
+extern char rgbOledBmp[];
+extern char *pbOledFontCur;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// FNV-1a over the drawn frame, to show both builds drew the same thing
+static uint32_t frameChecksum(void) {
+    uint32_t hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < ccolOledMax * crowOledMax / 8; i++) {
+        hash = (hash ^ (uint8_t)rgbOledBmp[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Put glyphs cell by cell, each cell moved down by yOffset pixels. Returns glyphs per second */
+static double benchPutBmp(long glyphs, int yOffset) {
+    int rows = (crowOledMax - yOffset) / 8;
+    double start;
+    long i;
+    int cell;
+
+    OrbitOledClearBuffer();
+    start = nowSeconds();
+    for (i = 0; i < glyphs; i++) {
+        // Step through the font so most bytes change, as they do when a value is redrawn
+        cell = i % (16 * rows);
+        OrbitOledMoveTo((cell % 16) * 8, (cell / 16) * 8 + yOffset);
+        OrbitOledPutBmp(8, 8, pbOledFontCur + ((i * 7) % BENCH_CHARS) * cbOledChar);
+    }
+    return glyphs / (nowSeconds() - start);
+}
+
+static double benchPutChar(long glyphs) {
+    double start;
+    long i;
+
+    OrbitOledClearBuffer();
+    OrbitOledSetCursor(0, 0);
+    start = nowSeconds();
+    for (i = 0; i < glyphs; i++) {
+        OrbitOledPutChar(BENCH_FIRST_CHAR + (i * 7) % BENCH_CHARS);
+    }
+    return glyphs / (nowSeconds() - start);
+}
+
+static double best(double rate, double fastest) {
+    return (rate > fastest) ? rate : fastest;
+}
+
+int main(int argc, char *argv[]) {
+    long glyphs = (argc > 1) ? atol(argv[1]) : BENCH_GLYPHS;
+    double aligned = 0;
+    double shifted = 0;
+    double text = 0;
+    uint32_t sumAligned;
+    uint32_t sumShifted;
+    int run;
+
+    OrbitOledInit();
+    OrbitOledSetCharUpdate(0);
+    OrbitOledSetDrawMode(modOledSet);
+
+    for (run = 0; run < BENCH_REPEATS; run++) {
+        aligned = best(benchPutBmp(glyphs, 0), aligned);
+        sumAligned = frameChecksum();
+        shifted = best(benchPutBmp(glyphs, 3), shifted);
+        sumShifted = frameChecksum();
+        text = best(benchPutChar(glyphs), text);
+    }
+
+#if defined(ORBITOLED_NO_FAST_BMP)
+    printf("Raster op only (ORBITOLED_NO_FAST_BMP), %ld glyphs per test\n", glyphs);
+#else
+    printf("Byte aligned fast path, %ld glyphs per test\n", glyphs);
+#endif
+    printf("  PutBmp on cells      %12.0f glyphs/s  checksum %08x\n", aligned, (unsigned)sumAligned);
+    printf("  PutBmp 3 rows down   %12.0f glyphs/s  checksum %08x\n", shifted, (unsigned)sumShifted);
+    printf("  PutChar              %12.0f glyphs/s\n", text);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * oledRegress.c
+ *
+ * Host regression for the OLED driver's dirty region refresh. Random drawing
+ * (every draw mode, colour and fill pattern, lines, fills, rectangles, bitmaps
+ * at any alignment and clipped at the edges, text and scrolling) is flushed a
+ * frame at a time through the SSD1306 emulator. After every frame the
+ * emulated display must hold exactly the front buffer (the flush sent every
+ * changed page span) and the back buffer the frame was drawn into (the
+ * drawing marked every byte it changed).
+ *
+ *     make -C host check
+ *     host/oledRegress [frames] [seed]
+ *
+ * The first mismatch is reported and the emulated display written to
+ * oledRegress.pbm. The exit status is non-zero if any frame mismatched.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "OrbitOled.h"
+#include "OrbitOledChar.h"
+#include "OrbitOledGrph.h"
+#include "OrbitOledEmu.h"
+
+#define REGRESS_FRAMES      5000
+#define REGRESS_MAX_OPS     6       // Drawing operations per frame
+#define REGRESS_PBM         "oledRegress.pbm"
+
+// Buffers owned by OrbitOled.c, the frame being drawn and the frame last presented
+extern char rgbOledBmp[];
+extern char rgbOledFront[];
+
+static int randomBelow(int n) {
+    return rand() % n;
+}
+
+static void randomDraw(void) {
+    static char bmp[32 * 4];
+    int i;
+
+    OrbitOledSetDrawMode(randomBelow(4));
+    OrbitOledSetDrawColor(randomBelow(2));
+    OrbitOledSetFillPattern(OrbitOledGetStdPattern(randomBelow(8)));
+    OrbitOledMoveTo(randomBelow(128), randomBelow(32));
+
+    switch (randomBelow(7)) {
+        case 0:
+            OrbitOledLineTo(randomBelow(128), randomBelow(32));
+            break;
+        case 1:
+            OrbitOledFillRect(randomBelow(128), randomBelow(32));
+            break;
+        case 2:
+            OrbitOledDrawRect(randomBelow(128), randomBelow(32));
+            break;
+        case 3:
+            // Byte aligned bitmaps take the fast path, the rest are shifted a pixel at a time.
+            // Bitmaps running off the right or bottom edge are clipped
+            for (i = 0; i < (int)sizeof(bmp); i++) {
+                bmp[i] = (char)rand();
+            }
+            if (randomBelow(2)) {
+                OrbitOledMoveTo(randomBelow(128), randomBelow(4) * 8);
+            }
+            OrbitOledPutBmp(randomBelow(32) + 1, (randomBelow(4) + 1) * 8, bmp);
+            break;
+        case 4:
+            OrbitOledSetCursor(randomBelow(16), randomBelow(4));
+            OrbitOledPutString("Alt 42% Yaw-170`");
+            break;
+        case 5:
+            OrbitOledDrawPixel();
+            break;
+        default:
+            OrbitOledScrollLeft(randomBelow(4), randomBelow(4), randomBelow(130));
+            break;
+    }
+}
+
+/* Compare the emulated display with a driver buffer, reporting and capturing the first mismatch */
+static bool checkFrame(int frame, char *pbBuf, const char *what) {
+    static bool reported = false;
+    int cbDiff = OrbitOledEmuCompare(pbBuf);
+
+    if (cbDiff == 0) {
+        return true;
+    }
+    if (!reported) {
+        reported = true;
+        printf("FAIL: frame %d, display differs from the %s (%d bytes)\n", frame, what, cbDiff);
+        OrbitOledEmuWritePbm(REGRESS_PBM);
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = (argc > 1) ? atoi(argv[1]) : REGRESS_FRAMES;
+    unsigned seed = (argc > 2) ? (unsigned)atoi(argv[2]) : 1;
+    unsigned long cbCmd;
+    unsigned long cbData;
+    int mismatches = 0;
+    int frame;
+    int op;
+
+    srand(seed);
+    OrbitOledInit();
+    OrbitOledSetCharUpdate(0);
+
+    if (!checkFrame(-1, rgbOledFront, "front buffer after OrbitOledInit")) {
+        mismatches++;
+    }
+
+    for (frame = 0; frame < frames; frame++) {
+        for (op = randomBelow(REGRESS_MAX_OPS); op > 0; op--) {
+            randomDraw();
+        }
+
+        // Present and flush as the display task does, or the blocking update
+        if (randomBelow(2)) {
+            if (OrbitOledPresent()) {
+                OrbitOledFlush();
+            }
+        } else {
+            OrbitOledUpdate();
+        }
+
+        if (!checkFrame(frame, rgbOledFront, "front buffer, a changed span was not sent")
+                || !checkFrame(frame, rgbOledBmp, "drawn frame, a changed byte was not marked dirty")) {
+            mismatches++;
+        }
+    }
+
+    OrbitOledEmuGetCounts(&cbCmd, &cbData);
+    printf("%d frames (seed %u): %lu command and %lu data bytes, %lu us on the SSI, %d mismatches\n",
+           frames, seed, cbCmd, cbData, OrbitOledEmuSendUs(), mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,2 @@
+// Host build stand-in, the header is PID.h and the target toolchain does not care about case
+#include "../PID.h"
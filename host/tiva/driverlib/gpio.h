@@ -0,0 +1,2 @@
+// Host build stand-in, see tivaHost.h
+#include "../tivaHost.h"
@@ -0,0 +1,77 @@
+/*
+ * tivaHost.h
+ *
+ * The TivaWare definitions the OLED driver uses, for building it on a PC
+ * against the SSD1306 emulator (OrbitOledEmu.c) instead of driverlib.
+ * Every inc/ and driverlib/ header in this directory includes only this file.
+ *
+ * Values match TivaWare so addresses and pin masks behave as on the target.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef TIVAHOST_H_
+#define TIVAHOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// inc/hw_types.h
+#define HWREG(x)                (*((volatile uint32_t *)(x)))
+
+// inc/hw_memmap.h
+#define GPIO_PORTD_BASE         0x40007000
+#define GPIO_PORTE_BASE         0x40024000
+#define SSI3_BASE               0x4000B000
+#define TIMER1_BASE             0x40031000
+
+// inc/hw_gpio.h, inc/hw_timer.h
+#define GPIO_O_LOCK             0x00000520
+#define GPIO_O_CR               0x00000524
+#define TIMER_O_TAV             0x00000050
+
+// driverlib/gpio.h
+#define GPIO_PIN_0              0x00000001
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_2              0x00000004
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_4              0x00000010
+#define GPIO_PIN_5              0x00000020
+#define GPIO_PIN_6              0x00000040
+#define GPIO_PIN_7              0x00000080
+
+// driverlib/sysctl.h
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_SSI3      0xf0001c03
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+
+// driverlib/ssi.h
+#define SSI_CLOCK_SYSTEM        0x00000000
+#define SSI_FRF_MOTO_MODE_0     0x00000000
+#define SSI_MODE_MASTER         0x00000000
+
+// driverlib/timer.h
+#define TIMER_A                 0x000000FF
+#define TIMER_CFG_PERIODIC_UP   0x00000012
+
+// Implemented by OrbitOledEmu.c
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinConfigure(uint32_t ui32PinConfig);
+void SSIDataPut(uint32_t ui32Base, uint32_t ui32Data);
+int32_t SSIDataGetNonBlocking(uint32_t ui32Base, uint32_t *pui32Data);
+void SSIDataGet(uint32_t ui32Base, uint32_t *pui32Data);
+bool SSIBusy(uint32_t ui32Base);
+void SSIClockSourceSet(uint32_t ui32Base, uint32_t ui32Source);
+void SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk, uint32_t ui32Protocol,
+                        uint32_t ui32Mode, uint32_t ui32BitRate, uint32_t ui32DataWidth);
+void SSIEnable(uint32_t ui32Base);
+uint32_t SysCtlClockGet(void);
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config);
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer);
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer);
+
+#endif /* TIVAHOST_H_ */
@@ -0,0 +1,21 @@
+/*
+ * lqrGains.h
+ *
+ * State feedback gains for [error, rate, integral of error], generated by
+ * tools/lqr_design.py. Do not edit by hand, re-run the tool instead:
+ *
+ *   python3 tools/lqr_design.py --main 2.0,0.7,1.5 --tail 3.0,0.5,2.0 --main-period 0.003 --tail-period 0.01 --q 1,0.05,0.5 --r 0.05
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef LQRGAINS_H_
+#define LQRGAINS_H_
+
+// main rotor model: wn = 2 rad/s, zeta = 0.7, gain = 1.5, designed for a 3 ms control period
+#define LQR_MAIN_GAINS    { 4.861226f, 1.211944f, 3.127658f }
+
+// tail rotor model: wn = 3 rad/s, zeta = 0.5, gain = 2, designed for a 10 ms control period
+#define LQR_TAIL_GAINS    { 4.343134f, 0.989736f, 2.868967f }
+
+#endif /* LQRGAINS_H_ */
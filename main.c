@@ -34,6 +34,7 @@
 #include "circBufT.h"
 #include "control.h"
 #include "display.h"
+#include "dma.h"
 #include "height.h"
 #include "priorities.h"
 #include "pwm.h"
@@ -42,27 +43,17 @@
 #include "userInputs.h"
 #include "yaw.h"
 
-systemState systemStatus;
-
-xSemaphoreHandle g_StatusMutex;
-
-void initHeliState(systemState *systemStatus) {
-    systemStatus->referenceAlt = 0;
-    systemStatus->targetYaw = 0;
-}
-
 int main(void) {
   //initialise the required peripherals
     SysCtlClockSet (SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ);
 
+    // The uDMA control table is shared, set it up before any driver uses a channel
+    initDMA();
+
     configUART();
 
     OLEDInitialise();
 
-    initHeliState(&systemStatus);
-
-    g_StatusMutex = xSemaphoreCreateMutex();
-
     //create the required tasks by calling the initialise
     //function in each module
 
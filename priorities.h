@@ -18,6 +18,7 @@
 //*****************************************************************************
 #define PRIORITY_UART_TASK      2
 #define PRIORITY_DISPLAY_TASK    2
+#define PRIORITY_DISPLAY_FLUSH_TASK 1
 #define PRIORITY_ADC_TASK        4
 #define PRIORITY_INPUT_TASK      4
 #define PRIORITY_CONTROL_TASK    3
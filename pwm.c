@@ -31,15 +31,12 @@
 #include "utils/uartstdio.h"
 #include "utils/ustdlib.h"
 
+#include "bus.h"
 #include "pid.h"
 #include "priorities.h"
 #include "pwm.h"
 #include "shared.h"
 
-extern systemState systemStatus;
-
-extern xSemaphoreHandle g_StatusMutex;
-
  /* --------------------------------------------
  *  Functions to initialise main rotor PWM tasks
  *  --------------------------------------------
@@ -73,23 +70,27 @@ void initMainPWM(void) {
 
 // Main rotor PWM task
 static void mainPWMTask(void* pvParameters) {
-    portTickType ui16LastTime;
     uint32_t ui32PollingDelay = 25;
     uint32_t ui32PwmPeriod =  SysCtlClockGet() / PWM_DIVIDER / PWM_START_RATE_HZ;
-    ui16LastTime = xTaskGetTickCount();
     while (1) {
+        flightStatus_t flight;
+        uint8_t ui8Duty;
+        busRead(TOPIC_STATE, &flight);
+        busRead(TOPIC_MAIN_DUTY, &ui8Duty);
+
         // Enable output.
-        if (systemStatus.state == TAKEOFF || systemStatus.state == FLYING || systemStatus.state == LANDING) {
-            xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-            PWMPulseWidthSet(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, ui32PwmPeriod * systemStatus.mainPWMDuty / 100);
+        if (isFlightState(flight.state)) {
+            PWMPulseWidthSet(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, ui32PwmPeriod * ui8Duty / 100);
             //Set the main PWM pulse width
 
-            xSemaphoreGive(g_StatusMutex);
             PWMOutputState(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, true);
             //Set the state of the main PWM
+        } else {
+            PWMOutputState(PWM_MAIN_BASE, PWM_MAIN_OUTBIT, false);
+            //Turn off main PWM on the ground, the height task has stopped updating its duty
         }
-        vTaskDelayUntil(&ui16LastTime, ui32PollingDelay / portTICK_RATE_MS);
-        // Wait for the required amount of tick, ensure a constant execution frequency
+        ulTaskNotifyTake(pdTRUE, ui32PollingDelay / portTICK_RATE_MS);
+        // Wait for a new duty to be published, or long enough to notice a change of state
     }
 }
 
@@ -97,9 +98,12 @@ static void mainPWMTask(void* pvParameters) {
 uint32_t initMainPWMTask(void) {
     initMainPWM();
 
-    if (xTaskCreate(mainPWMTask, (const portCHAR*)"Main PWM", 128, NULL, PRIORITY_MAIN_PWM_TASK, NULL) != pdTRUE) {
+    xTaskHandle mainPWMHandle;
+
+    if (xTaskCreate(mainPWMTask, (const portCHAR*)"Main PWM", 128, NULL, PRIORITY_MAIN_PWM_TASK, &mainPWMHandle) != pdTRUE) {
         return (1);
     }
+    busSubscribe(TOPIC_MAIN_DUTY, mainPWMHandle, BUS_NOTIFY_UPDATED);
     UARTprintf(" Main Rotor PWM initialized \n");
     return (0);
 }
@@ -136,26 +140,27 @@ void initTailPWM(void) {
 
 // Tail rotor PWM task similiarly to the main PWM task
 static void tailPWMTask(void* pvParameters) {
-    portTickType ui16LastTime;
     uint32_t ui32PollingDelay = 25;
     uint32_t ui32PwmPeriod =  SysCtlClockGet() / PWM_DIVIDER / PWM_START_RATE_HZ;
-    ui16LastTime = xTaskGetTickCount();
     while (1) {
-        if (systemStatus.state == IDLE) { //If the state is IDLE
+        flightStatus_t flight;
+        uint8_t ui8Duty;
+        busRead(TOPIC_STATE, &flight);
+        busRead(TOPIC_TAIL_DUTY, &ui8Duty);
+
+        if (flight.state == IDLE) { //If the state is IDLE
             PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, false);
             //Turn off tail PWM
         }
         else { // if the state is not IDLE
-            xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-            PWMPulseWidthSet(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, ui32PwmPeriod * systemStatus.tailPWMDuty / 100);
+            PWMPulseWidthSet(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, ui32PwmPeriod * ui8Duty / 100);
             //Set the pulse width for tail PWM
 
-            xSemaphoreGive(g_StatusMutex);
             PWMOutputState(PWM_TAIL_BASE, PWM_TAIL_OUTBIT, true);
             //Set the PWM output state for the tail PWM
         }
-        vTaskDelayUntil(&ui16LastTime, ui32PollingDelay / portTICK_RATE_MS);
-        // Wait for the required amount of time to check back, ensure a constant execution frequency
+        ulTaskNotifyTake(pdTRUE, ui32PollingDelay / portTICK_RATE_MS);
+        // Wait for a new duty to be published, or long enough to notice a change of state
     }
 }
 
@@ -163,9 +168,12 @@ static void tailPWMTask(void* pvParameters) {
 uint32_t initTailPWMTask(void) {
     initTailPWM();
 
-    if (xTaskCreate(tailPWMTask, (const portCHAR*)"Tail PWM", 128, NULL, PRIORITY_TAIL_PWM_TASK, NULL) != pdTRUE) {
+    xTaskHandle tailPWMHandle;
+
+    if (xTaskCreate(tailPWMTask, (const portCHAR*)"Tail PWM", 128, NULL, PRIORITY_TAIL_PWM_TASK, &tailPWMHandle) != pdTRUE) {
         return (1);
     }
+    busSubscribe(TOPIC_TAIL_DUTY, tailPWMHandle, BUS_NOTIFY_UPDATED);
     UARTprintf(" Tail Rotor PWM initialized \n");
     return (0);
 }
@@ -0,0 +1,43 @@
+/*
+ * seqlock.c
+ *
+ * Sequence lock over two copies of a value. Writers never block and readers get
+ * a consistent snapshot without taking a mutex.
+ *
+ * Relies on a single core: volatile accesses keep the compiler from reordering
+ * the copies around the sequence count, and the CPU sees its own stores in order.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "seqlock.h"
+
+static void copyBytes(volatile uint8_t *to, const volatile uint8_t *from, size_t size) {
+    while (size-- > 0) {
+        *to++ = *from++;
+    }
+}
+
+void seqlockWrite(seqlock_t *lock, void *copies, const void *value, size_t size) {
+    volatile uint8_t *copy = copies;
+
+    lock->sequence++;   // odd, readers use copy 1 while copy 0 is written
+    copyBytes(copy, value, size);
+    lock->sequence++;   // even, readers use the new copy 0 while copy 1 is brought up to date
+    copyBytes(copy + size, value, size);
+}
+
+uint32_t seqlockRead(const seqlock_t *lock, const void *copies, void *value, size_t size) {
+    const volatile uint8_t *copy = copies;
+    uint32_t sequence;
+
+    do {
+        sequence = lock->sequence;
+        copyBytes(value, copy + (sequence & 1) * size, size);
+    } while (lock->sequence != sequence);
+
+    return sequence;
+}
@@ -0,0 +1,50 @@
+/*
+ * seqlock.h
+ *
+ * Header for seqlock.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct              seqlock_t.
+ * @brief               Sequence count for a single writer, many reader value kept as two copies.
+ * @brief               Readers take the copy the writer is not currently changing, so a reader that preempts
+ *                      the writer part way through an update still reads the previous value instead of spinning.
+ *
+ * @param sequence      Incremented before each copy is written, the low bit selects the copy readers use.
+*/
+typedef struct _seqlock_t {
+    volatile uint32_t sequence;
+} seqlock_t;
+
+
+/**
+ * @function        seqlockWrite.
+ * @brief           Publish a new value. Never blocks, must only be called by the value's one writer.
+ * @param lock      Pointer to the sequence count.
+ * @param copies    Storage for two copies of the value (e.g. an array of 2).
+ * @param value     Value to publish.
+ * @param size      Size of one copy in bytes.
+*/
+void seqlockWrite(seqlock_t *lock, void *copies, const void *value, size_t size);
+
+
+/**
+ * @function        seqlockRead.
+ * @brief           Take a consistent snapshot of the value. Only retries if the writer ran during the copy.
+ * @param lock      Pointer to the sequence count.
+ * @param copies    Storage for two copies of the value, as passed to seqlockWrite.
+ * @param value     Snapshot to fill.
+ * @param size      Size of one copy in bytes.
+ * @returns         uint32_t: Sequence count the snapshot was taken at, changes every time the value is published.
+*/
+uint32_t seqlockRead(const seqlock_t *lock, const void *copies, void *value, size_t size);
+
+#endif /* SEQLOCK_H_ */
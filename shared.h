@@ -21,43 +21,104 @@ typedef enum _programState {
     CALIBRATE,
     TAKEOFF,
     FLYING,
-    LANDING
+    LANDING,
+    AUTOTUNE,
+    SYSID,
+    NUM_PROGRAM_STATES
 } programState;
 
 
 /**
- * @struct                  systemState.
- * @brief                   Contains system state variables.
- * @brief                   System state variables (state, system_on, altCalibrated, ...) are stored in this structure.
- * 
- * @param state             System state structure.     
- * @param system_on         System on flag (Left switch ON position).
+ * @function        isFlightState.
+ * @brief           Rotors are driven and the control loops run in this state.
+ * @param state     Flight state to check.
+ * @returns         bool: true for TAKEOFF, FLYING, LANDING, AUTOTUNE and SYSID, else false.
+*/
+static inline bool isFlightState(programState state) {
+    return state == TAKEOFF || state == FLYING || state == LANDING || state == AUTOTUNE || state == SYSID;
+}
+
+
+/**
+ * @struct                  flightStatus_t.
+ * @brief                   Flight state and setpoints. Written only by the control task.
+ *
+ * @param state             System state structure.
  * @param yawCalibrated     Yaw calibrated flag.
  * @param referenceAlt      Reference raw altitude.
- * @param currentAlt        Current raw altitude.
- * @param currentAltPercent Percentage altitude.
- * @param currentYaw        Current yaw value.
- * @param targetYaw         Target yaw value.
- * @param currentYawDegrees Current yaw in degrees.
- * @param mainPWMDuty       mainPWMDuty value.
- * @param tailPWMDuty       tailPWMDuty value.
+ * @param targetAlt         Target altitude (percent).
+ * @param targetYaw         Target yaw (degrees, -180 to 179).
+ * @param refAlt            Smoothed altitude setpoint (percent) from the trajectory generator, tracked by the main rotor PID.
+ * @param refYaw            Smoothed yaw setpoint (degrees, -180 to 180) from the trajectory generator, tracked by the tail rotor PID.
 */
-typedef struct _systemState {
+typedef struct _flightStatus_t {
     programState state;
-    bool system_on;
     bool yawCalibrated;
     uint32_t referenceAlt;
-    int32_t currentAlt;
     uint32_t targetAlt;
+    int32_t targetYaw;
+    float refAlt;
+    float refYaw;
+} flightStatus_t;
+
+
+/**
+ * @struct                  altStatus_t.
+ * @brief                   Altitude measurement. Written only by the height task.
+ *
+ * @param currentAlt        Current raw altitude.
+ * @param currentAltPercent Percentage altitude.
+*/
+typedef struct _altStatus_t {
+    int32_t currentAlt;
     int32_t currentAltPercent;
-    uint32_t currentYaw;
-    uint32_t targetYaw;
-    uint32_t currentYawDegrees;
+} altStatus_t;
+
+
+/**
+ * @struct                  yawStatus_t.
+ * @brief                   Yaw measurement. Written only by the yaw task.
+ *
+ * @param currentYawDegrees Current yaw in degrees (-180 to 179, negative is anticlockwise of the reference).
+*/
+typedef struct _yawStatus_t {
+    int32_t currentYawDegrees;
+} yawStatus_t;
+
+
+/**
+ * @struct                  inputStatus_t.
+ * @brief                   Switch state. Written only by the inputs task.
+ *
+ * @param system_on         System on flag (Left switch ON position).
+*/
+typedef struct _inputStatus_t {
+    bool system_on;
+} inputStatus_t;
+
+
+/**
+ * @struct                  systemState.
+ * @brief                   Snapshot of all system state variables, one bus topic per member.
+ * @brief                   Each topic is published with a sequence lock (see bus.h) so it is always self consistent.
+ *
+ * @param flight            Flight state and setpoints (control task).
+ * @param alt               Altitude (height task).
+ * @param yaw               Yaw (yaw task).
+ * @param mainPWMDuty       Main rotor duty (height task).
+ * @param tailPWMDuty       Tail rotor duty (yaw task).
+ * @param input             Switch state (inputs task).
+*/
+typedef struct _systemState {
+    flightStatus_t flight;
+    altStatus_t alt;
+    yawStatus_t yaw;
     uint8_t mainPWMDuty;
     uint8_t tailPWMDuty;
+    inputStatus_t input;
 } systemState;
 
-// Not really needed, but allows lookup of systemStatus.state to display current system state as a string instead of enum value
-static const char *statesLookup[6] = {"IDLE", "CALIBRATE", "TAKEOFF", "FLYING", "LANDING", "LANDED"};
+// Not really needed, but allows lookup of the flight state to display current system state as a string instead of enum value
+static const char *statesLookup[NUM_PROGRAM_STATES] = {"IDLE", "CALIBRATE", "TAKEOFF", "FLYING", "LANDING", "AUTOTUNE", "SYSID"};
 
 #endif /* SHARED_H_ */
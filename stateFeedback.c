@@ -0,0 +1,37 @@
+/*
+ * stateFeedback.c
+ *
+ * Discrete state feedback controller. The gains are computed offline from an
+ * identified model so each update is a rate estimate and three multiply-accumulates.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+
+#include "stateFeedback.h"
+
+uint32_t stateFeedback(float input, float setpoint, float feedforward, float period, sf_struct *sfObj) {
+    float error = input - setpoint;
+
+    sfObj->rate += sfObj->rate_alpha * ((input - sfObj->prev_input) / period - sfObj->rate);
+    sfObj->prev_input = input;
+
+    float control = feedforward - (sfObj->K[0] * error + sfObj->K[1] * sfObj->rate + sfObj->K[2] * sfObj->I);
+
+// Clamp values for control to range 2 - 98% for PWM
+    if (control > sfObj->output_max){
+        control = sfObj->output_max;
+    } else if (control < sfObj->output_min){
+        control = sfObj->output_min;
+    } else {
+        sfObj->I += error * period;
+    }
+    return (uint32_t)control;
+}
+
+void resetStateFeedback(float input, sf_struct *sfObj) {
+    sfObj->prev_input = input;
+    sfObj->rate = 0;
+    sfObj->I = 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * stateFeedback.h
+ *
+ * Header for stateFeedback.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef STATEFEEDBACK_H_
+#define STATEFEEDBACK_H_
+
+#include <stdint.h>
+
+#define SF_STATES       3       // [error, rate, integral of error]
+
+/**
+ * @enum            controller_t.
+ * @brief           Controller used for an axis.
+*/
+typedef enum _controller_t {
+    CTRL_PID = 0,
+    CTRL_STATE_FEEDBACK
+} controller_t;
+
+
+/**
+ * @struct              sf_struct.
+ * @brief               Contains a discrete state feedback (LQR) controller for one axis.
+ * @brief               K is generated offline by tools/lqr_design.py into lqrGains.h, the rest is runtime state.
+ *
+ * @param K             Gains for the state [measured - setpoint, measured rate, integral of (measured - setpoint)].
+ * @param rate_alpha    Smoothing factor (0 - 1) for the rate estimate, lower is smoother.
+ * @param prev_input    Measurement at the last update.
+ * @param rate          Filtered rate estimate (units / s).
+ * @param I             Integral of the error (units * s), supplies the trim duty.
+ * @param output_min    Minimum output value (limits minimum motor duty cycle)
+ * @param output_max    Maximum output value (limits maximum motor duty cycle)
+*/
+typedef struct _sf_struct {
+    const float K[SF_STATES];
+    const float rate_alpha;
+    float prev_input;
+    float rate;
+    float I;
+    const uint8_t output_min;
+    const uint8_t output_max;
+} sf_struct;
+
+
+/**
+ * @function            stateFeedback.
+ * @brief               Calculate the output command u = feedforward - K x for a state feedback structure.
+ *                      The integral only winds up while the output is within range, as with pidFeedforward.
+ * @param input         Current measured value.
+ * @param setpoint      Target value.
+ * @param feedforward   Feedforward value added to the output.
+ * @param period        Change in time since last update.
+ * @param sfObj         Pointer to a state feedback structure.
+ * @returns             uint32_t: Current output command from the controller.
+*/
+uint32_t stateFeedback(float input, float setpoint, float feedforward, float period, sf_struct *sfObj);
+
+
+/**
+ * @function        resetStateFeedback.
+ * @brief           Clear the integral and start the rate estimate from rest at a measured value, call while the axis is not being controlled.
+ * @param input     Current measured value.
+ * @param sfObj     Pointer to a state feedback structure.
+*/
+void resetStateFeedback(float input, sf_struct *sfObj);
+
+#endif /* STATEFEEDBACK_H_ */
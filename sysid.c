@@ -0,0 +1,135 @@
+/*
+ * sysid.c
+ *
+ * System identification excitation (PRBS / chirp) added to the main or tail duty
+ * while the PID loops hold a trim point, with input / output logged into a RAM ring
+ * buffer by the task running that rotor's loop, so each sample pairs the duty applied
+ * with the measurement it was computed from. tools/sysid_fit.py fits a model to the
+ * dumped log.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sysid.h"
+
+#define SYSID_PI    3.14159265f
+
+// Set last by sysidStart, the height task logs main axis runs while the control task starts and stops them
+static volatile bool g_running = false;
+static uint32_t g_runs = 0;
+static sysidAxis_t g_axis;
+static sysidSignal_t g_signal;
+static uint32_t g_startMs;
+
+// PRBS state, a 7 bit maximal length LFSR (x^7 + x^6 + 1) stepped once per bit
+static uint8_t g_lfsr;
+static uint32_t g_bit;
+
+static sysidSample_t g_log[SYSID_LOG_SIZE];
+static uint32_t g_logHead;     // next entry to write
+static uint32_t g_logCount;
+
+void sysidStart(sysidAxis_t axis, sysidSignal_t signal, uint32_t nowMs) {
+    g_axis = axis;
+    g_signal = signal;
+    g_startMs = nowMs;
+    g_lfsr = 0x7F;
+    g_bit = 0;
+    g_logHead = 0;
+    g_logCount = 0;
+    g_running = true;
+}
+
+float sysidExcitation(sysidAxis_t axis, uint32_t nowMs) {
+    if (!g_running || axis != g_axis) {
+        return 0;
+    }
+
+    uint32_t elapsed = nowMs - g_startMs;
+    float amplitude = (axis == SYSID_MAIN) ? SYSID_MAIN_AMPLITUDE : SYSID_TAIL_AMPLITUDE;
+
+    if (g_signal == SYSID_PRBS) {
+        // Step the LFSR for every bit period that has passed
+        while (g_bit < elapsed / SYSID_PRBS_BIT_MS) {
+            uint8_t feedback = ((g_lfsr >> 6) ^ (g_lfsr >> 5)) & 1;
+            g_lfsr = ((g_lfsr << 1) | feedback) & 0x7F;
+            g_bit++;
+        }
+        return (g_lfsr & 1) ? amplitude : -amplitude;
+    }
+
+    // Linear chirp, phase = 2 pi (f0 t + (f1 - f0) t^2 / 2T)
+    float t = elapsed / 1000.0f;
+    float T = SYSID_DURATION_MS / 1000.0f;
+    float phase = 2 * SYSID_PI * (SYSID_CHIRP_START_HZ * t + (SYSID_CHIRP_END_HZ - SYSID_CHIRP_START_HZ) * t * t / (2 * T));
+    return amplitude * sinf(phase);
+}
+
+bool sysidLog(uint32_t nowMs, uint8_t mainDuty, uint8_t tailDuty, int32_t alt, int32_t yaw) {
+    if (!g_running) {
+        return false;
+    }
+
+    uint32_t elapsed = nowMs - g_startMs;
+    if (elapsed >= SYSID_DURATION_MS) {
+        sysidStop();
+        return false;
+    }
+
+    sysidSample_t *sample = &g_log[g_logHead];
+    sample->timeMs = elapsed;
+    sample->mainDuty = mainDuty;
+    sample->tailDuty = tailDuty;
+    sample->alt = alt;
+    sample->yaw = yaw;
+
+    g_logHead++;
+    if (g_logHead >= SYSID_LOG_SIZE) {
+        g_logHead = 0;
+    }
+    if (g_logCount < SYSID_LOG_SIZE) {
+        g_logCount++;
+    }
+    return true;
+}
+
+bool sysidLogging(sysidAxis_t axis) {
+    return g_running && g_axis == axis;
+}
+
+uint32_t sysidLogPeriodMs(void) {
+    return (g_axis == SYSID_MAIN) ? SYSID_MAIN_PERIOD_MS : SYSID_TAIL_PERIOD_MS;
+}
+
+void sysidStop(void) {
+    if (g_running) {
+        g_running = false;
+        g_runs++;
+    }
+}
+
+uint32_t sysidRunCount(void) {
+    return g_runs;
+}
+
+uint32_t sysidLogCount(void) {
+    return g_logCount;
+}
+
+const sysidSample_t *sysidLogSample(uint32_t index) {
+    // Oldest sample is at the head once the buffer has wrapped
+    uint32_t start = (g_logCount < SYSID_LOG_SIZE) ? 0 : g_logHead;
+    return &g_log[(start + index) % SYSID_LOG_SIZE];
+}
+
+sysidAxis_t sysidAxis(void) {
+    return g_axis;
+}
+
+sysidSignal_t sysidSignalType(void) {
+    return g_signal;
+}
@@ -0,0 +1,165 @@
+/*
+ * sysid.h
+ *
+ * Header for sysid.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef SYSID_H_
+#define SYSID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSID_ALT               50      // Trim altitude (%) the excitation is applied around
+#define SYSID_LOG_SIZE          1024    // Samples kept in the RAM log, a whole run at either axis' log period
+#define SYSID_MAIN_PERIOD_MS    12      // Main axis log period, every 4th 3 ms height step (every step would not fit in RAM)
+#define SYSID_TAIL_PERIOD_MS    10      // Tail axis log period, every control period
+#define SYSID_DURATION_MS       10000   // Length of the excitation
+#define SYSID_MAIN_AMPLITUDE    5       // Main duty excitation amplitude (%)
+#define SYSID_TAIL_AMPLITUDE    8       // Tail duty excitation amplitude (%)
+#define SYSID_PRBS_BIT_MS       80      // PRBS bit length, 127 bit sequence covers the whole run
+#define SYSID_CHIRP_START_HZ    0.1f    // Chirp start frequency
+#define SYSID_CHIRP_END_HZ      3.0f    // Chirp end frequency
+#define SYSID_SIGNAL            SYSID_PRBS  // Excitation signal used by the SYSID flight state
+
+
+/**
+ * @enum            sysidAxis.
+ * @brief           Rotor the excitation is added to.
+*/
+typedef enum _sysidAxis {
+    SYSID_MAIN = 0,
+    SYSID_TAIL
+} sysidAxis_t;
+
+
+/**
+ * @enum            sysidSignal.
+ * @brief           Excitation signal type.
+*/
+typedef enum _sysidSignal {
+    SYSID_PRBS = 0,     // Pseudo random binary sequence (7 bit LFSR), flat spectrum up to about 1 / (2 * bit length)
+    SYSID_CHIRP         // Linear frequency sweep from SYSID_CHIRP_START_HZ to SYSID_CHIRP_END_HZ
+} sysidSignal_t;
+
+
+/**
+ * @struct          sysidSample_t.
+ * @brief           One logged sample, 8 bytes so the whole log fits in 8 KB of RAM.
+ *
+ * @param timeMs    Time since the excitation started (ms).
+ * @param mainDuty  Main rotor duty applied (%).
+ * @param tailDuty  Tail rotor duty applied (%).
+ * @param alt       Altitude (%).
+ * @param yaw       Yaw (degrees).
+*/
+typedef struct _sysidSample_t {
+    uint16_t timeMs;
+    uint8_t mainDuty;
+    uint8_t tailDuty;
+    int16_t alt;
+    int16_t yaw;
+} sysidSample_t;
+
+
+/**
+ * @function        sysidStart.
+ * @brief           Clear the log and start the excitation.
+ * @param axis      Rotor to excite.
+ * @param signal    Excitation signal type.
+ * @param nowMs     Current time (ms).
+*/
+void sysidStart(sysidAxis_t axis, sysidSignal_t signal, uint32_t nowMs);
+
+
+/**
+ * @function        sysidExcitation.
+ * @brief           Excitation to add to a rotor's duty.
+ * @param axis      Rotor asking for its excitation.
+ * @param nowMs     Current time (ms).
+ * @returns         float: Duty offset (%), 0 if not running or a different rotor is being excited.
+*/
+float sysidExcitation(sysidAxis_t axis, uint32_t nowMs);
+
+
+/**
+ * @function        sysidLog.
+ * @brief           Add a sample to the RAM ring buffer while the excitation runs.
+ * @param nowMs     Current time (ms).
+ * @param mainDuty  Main rotor duty (%).
+ * @param tailDuty  Tail rotor duty (%).
+ * @param alt       Altitude (%).
+ * @param yaw       Yaw (degrees).
+ * @returns         bool: true while the excitation is still running, false once SYSID_DURATION_MS has passed.
+*/
+bool sysidLog(uint32_t nowMs, uint8_t mainDuty, uint8_t tailDuty, int32_t alt, int32_t yaw);
+
+
+/**
+ * @function        sysidLogging.
+ * @brief           Whether a run exciting the given rotor is in progress, so its samples should be logged.
+ *                  Main axis runs are logged by the height task, tail axis runs by the control task.
+ * @param axis      Rotor to check.
+ * @returns         bool: true while the excitation of axis is running.
+*/
+bool sysidLogging(sysidAxis_t axis);
+
+
+/**
+ * @function        sysidLogPeriodMs.
+ * @brief           Period the last run was logged at.
+ * @returns         uint32_t: SYSID_MAIN_PERIOD_MS or SYSID_TAIL_PERIOD_MS (ms).
+*/
+uint32_t sysidLogPeriodMs(void);
+
+
+/**
+ * @function        sysidStop.
+ * @brief           Stop the excitation, leaving the log to be dumped.
+*/
+void sysidStop(void);
+
+
+/**
+ * @function        sysidRunCount.
+ * @brief           Number of runs finished (completed or stopped), used to tell when there is a new log to dump.
+ * @returns         uint32_t: Finished run count.
+*/
+uint32_t sysidRunCount(void);
+
+
+/**
+ * @function        sysidLogCount.
+ * @brief           Number of samples in the log.
+ * @returns         uint32_t: Sample count, at most SYSID_LOG_SIZE.
+*/
+uint32_t sysidLogCount(void);
+
+
+/**
+ * @function        sysidLogSample.
+ * @brief           Read a sample from the log, oldest first.
+ * @param index     Sample index, 0 to sysidLogCount() - 1.
+ * @returns         const sysidSample_t*: Pointer to the sample.
+*/
+const sysidSample_t *sysidLogSample(uint32_t index);
+
+
+/**
+ * @function        sysidAxis.
+ * @brief           Rotor excited by the last run.
+ * @returns         sysidAxis_t: Axis of the last run.
+*/
+sysidAxis_t sysidAxis(void);
+
+
+/**
+ * @function        sysidSignalType.
+ * @brief           Signal used by the last run.
+ * @returns         sysidSignal_t: Signal of the last run.
+*/
+sysidSignal_t sysidSignalType(void);
+
+#endif /* SYSID_H_ */
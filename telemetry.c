@@ -0,0 +1,164 @@
+/*
+ * telemetry.c
+ *
+ * Binary telemetry frames: fixed little endian layout, CRC-16 and COBS framing.
+ * Has no FreeRTOS or hardware dependencies, the UART task fills the structures and sends the frames.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "telemetry.h"
+
+#define TELEMETRY_STATUS_LENGTH         28
+#define TELEMETRY_DIAGNOSTICS_LENGTH    40
+
+static uint32_t putU8(uint8_t *buffer, uint32_t index, uint8_t value) {
+    buffer[index] = value;
+    return index + 1;
+}
+
+static uint32_t putU16(uint8_t *buffer, uint32_t index, uint16_t value) {
+    buffer[index] = value & 0xFF;
+    buffer[index + 1] = value >> 8;
+    return index + 2;
+}
+
+static uint32_t putU32(uint8_t *buffer, uint32_t index, uint32_t value) {
+    index = putU16(buffer, index, value & 0xFFFF);
+    return putU16(buffer, index, value >> 16);
+}
+
+// Scale by 10 and round to the nearest int16, e.g. a setpoint to 0.1 units
+static int16_t tenths(float value) {
+    float scaled = value * 10.0f;
+
+    if (scaled >= INT16_MAX) {
+        return INT16_MAX;
+    } else if (scaled <= INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+}
+
+/* Bitwise CRC, frames are short enough that a lookup table is not worth the flash */
+uint16_t telemetryCrc16(const uint8_t *data, uint32_t length) {
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint32_t cobsEncode(const uint8_t *data, uint32_t length, uint8_t *encoded) {
+    uint32_t codeIndex = 0;     // Where the length of the current block goes
+    uint32_t out = 1;
+    uint8_t code = 1;
+    uint32_t i;
+
+    for (i = 0; i < length; i++) {
+        if (data[i] == 0) {
+            encoded[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        } else {
+            encoded[out++] = data[i];
+            code++;
+        }
+    }
+    encoded[codeIndex] = code;
+    return out;
+}
+
+// Add the version, type and sequence number in front of a payload and the CRC after it, then COBS encode
+static uint32_t finishFrame(uint8_t *raw, uint32_t payloadLength, telemetryType_t type, uint16_t sequence, uint8_t *frame) {
+    uint32_t length = TELEMETRY_HEADER_LENGTH + payloadLength;
+
+    raw[0] = TELEMETRY_VERSION;
+    raw[1] = type;
+    putU16(raw, 2, sequence);
+    length = putU16(raw, length, telemetryCrc16(raw, length));
+
+    frame[0] = 0;
+    length = cobsEncode(raw, length, &frame[1]) + 1;
+    frame[length++] = 0;
+    return length;
+}
+
+/* Status payload:
+ *   4  u32  time (ms)
+ *   8  u8   state
+ *   9  u8   flags: bit 0 system on, bit 1 yaw calibrated
+ *  10  i16  altitude (%)
+ *  12  i16  target altitude (%)
+ *  14  i16  altitude setpoint (0.1%)
+ *  16  i16  yaw (degrees)
+ *  18  i16  target yaw (degrees)
+ *  20  i16  yaw setpoint (0.1 degrees)
+ *  22  u8   main duty (%)
+ *  23  u8   tail duty (%)
+ *  24  i32  raw altitude
+ *  28  u16  altitude age (ms)
+ *  30  u16  yaw age (ms) */
+uint32_t telemetryEncodeStatus(const telemetryStatus_t *status, uint16_t sequence, uint8_t *frame) {
+    uint8_t raw[TELEMETRY_HEADER_LENGTH + TELEMETRY_STATUS_LENGTH + 2];
+    uint32_t i = TELEMETRY_HEADER_LENGTH;
+
+    i = putU32(raw, i, status->timeMs);
+    i = putU8(raw, i, status->state);
+    i = putU8(raw, i, (status->systemOn ? 0x01 : 0) | (status->yawCalibrated ? 0x02 : 0));
+    i = putU16(raw, i, status->alt);
+    i = putU16(raw, i, status->targetAlt);
+    i = putU16(raw, i, tenths(status->refAlt));
+    i = putU16(raw, i, status->yaw);
+    i = putU16(raw, i, status->targetYaw);
+    i = putU16(raw, i, tenths(status->refYaw));
+    i = putU8(raw, i, status->mainDuty);
+    i = putU8(raw, i, status->tailDuty);
+    i = putU32(raw, i, status->rawAlt);
+    i = putU16(raw, i, status->altAgeMs);
+    putU16(raw, i, status->yawAgeMs);
+
+    return finishFrame(raw, TELEMETRY_STATUS_LENGTH, TELEMETRY_STATUS, sequence, frame);
+}
+
+/* Diagnostics payload:
+ *   4  u32  time (ms)
+ *   8  u32  state machine transitions
+ *  12  u32  state machine events ignored
+ *  16  u16  last transition latency (ms)
+ *  18  u16  maximum transition latency (ms)
+ *  20  u32  input events dropped
+ *  24  u32  yaw revolutions
+ *  28  i16  last yaw drift (counts)
+ *  30  u16  maximum yaw drift (counts)
+ *  32  u32  yaw encoder slips
+ *  36  u32  telemetry frames dropped
+ *  40  u32  UART bytes dropped */
+uint32_t telemetryEncodeDiagnostics(const telemetryDiagnostics_t *diag, uint16_t sequence, uint8_t *frame) {
+    uint8_t raw[TELEMETRY_HEADER_LENGTH + TELEMETRY_DIAGNOSTICS_LENGTH + 2];
+    uint32_t i = TELEMETRY_HEADER_LENGTH;
+
+    i = putU32(raw, i, diag->timeMs);
+    i = putU32(raw, i, diag->transitions);
+    i = putU32(raw, i, diag->ignored);
+    i = putU16(raw, i, diag->lastLatencyMs);
+    i = putU16(raw, i, diag->maxLatencyMs);
+    i = putU32(raw, i, diag->inputDrops);
+    i = putU32(raw, i, diag->yawRevolutions);
+    i = putU16(raw, i, diag->yawLastDrift);
+    i = putU16(raw, i, diag->yawMaxDrift);
+    i = putU32(raw, i, diag->yawSlips);
+    i = putU32(raw, i, diag->telemetryDrops);
+    putU32(raw, i, diag->uartDroppedBytes);
+
+    return finishFrame(raw, TELEMETRY_DIAGNOSTICS_LENGTH, TELEMETRY_DIAGNOSTICS, sequence, frame);
+}
@@ -0,0 +1,155 @@
+/*
+ * telemetry.h
+ *
+ * Header for telemetry.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Frame layout (all fields little endian), version 3:
+ *   0  u8   TELEMETRY_VERSION
+ *   1  u8   frame type (telemetryType_t)
+ *   2  u16  sequence number, counts every frame including any dropped
+ *   4  ...  payload, see telemetryEncodeStatus / telemetryEncodeDiagnostics
+ *   n  u16  CRC-16/CCITT-FALSE of bytes 0 to n-1
+ * The whole frame is COBS encoded between two 0x00 delimiters, so a receiver can resynchronise at any 0x00
+ * and text printed between frames by other tasks only ever costs itself.
+ * Decoded by tools/telemetry_decode.py, change both together and bump the version for any layout change. */
+#define TELEMETRY_VERSION       3
+
+#define TELEMETRY_HEADER_LENGTH 4
+#define TELEMETRY_MAX_PAYLOAD   40
+// Header, payload and CRC plus one COBS overhead byte and the two delimiters
+#define TELEMETRY_MAX_FRAME     (TELEMETRY_HEADER_LENGTH + TELEMETRY_MAX_PAYLOAD + 2 + 3)
+
+/**
+ * @enum            telemetryType_t.
+ * @brief           Telemetry frame types.
+*/
+typedef enum _telemetryType_t {
+    TELEMETRY_STATUS = 1,       // Flight state and measurements, sent every telemetry period
+    TELEMETRY_DIAGNOSTICS       // Event, drop and yaw drift counters, sent less often
+} telemetryType_t;
+
+
+/**
+ * @struct                  telemetryStatus_t.
+ * @brief                   Contents of a TELEMETRY_STATUS frame.
+ *
+ * @param timeMs            Time the status was read (ms since start).
+ * @param state             Flight state (programState).
+ * @param systemOn          System on switch.
+ * @param yawCalibrated     Yaw reference has been found.
+ * @param alt               Altitude (%).
+ * @param targetAlt         Target altitude (%).
+ * @param refAlt            Altitude setpoint from the trajectory generator (%), sent to 0.1%.
+ * @param yaw               Yaw (degrees).
+ * @param targetYaw         Target yaw (degrees).
+ * @param refYaw            Yaw setpoint from the trajectory generator (degrees), sent to 0.1 degrees.
+ * @param mainDuty          Main rotor duty (%).
+ * @param tailDuty          Tail rotor duty (%).
+ * @param rawAlt            Raw averaged altitude ADC value.
+ * @param altAgeMs          Time since the altitude was last published (ms).
+ * @param yawAgeMs          Time since the yaw was last published (ms).
+*/
+typedef struct _telemetryStatus_t {
+    uint32_t timeMs;
+    uint8_t state;
+    bool systemOn;
+    bool yawCalibrated;
+    int16_t alt;
+    int16_t targetAlt;
+    float refAlt;
+    int16_t yaw;
+    int16_t targetYaw;
+    float refYaw;
+    uint8_t mainDuty;
+    uint8_t tailDuty;
+    int32_t rawAlt;
+    uint16_t altAgeMs;
+    uint16_t yawAgeMs;
+} telemetryStatus_t;
+
+
+/**
+ * @struct                  telemetryDiagnostics_t.
+ * @brief                   Contents of a TELEMETRY_DIAGNOSTICS frame.
+ *
+ * @param timeMs            Time the counters were read (ms since start).
+ * @param transitions       Flight state machine transitions taken.
+ * @param ignored           Flight state machine events ignored.
+ * @param lastLatencyMs     Input to transition latency of the last transition (ms).
+ * @param maxLatencyMs      Largest input to transition latency (ms).
+ * @param inputDrops        Input events dropped because the input queue was full.
+ * @param yawRevolutions    Yaw reference pulses seen.
+ * @param yawLastDrift      Yaw count error found at the last reference pulse.
+ * @param yawMaxDrift       Largest yaw count error found.
+ * @param yawSlips          Revolutions with an encoder slip.
+ * @param telemetryDrops    Telemetry frames not sent.
+ * @param uartDroppedBytes  Bytes of text and frames the UART transmit buffer had no room for.
+*/
+typedef struct _telemetryDiagnostics_t {
+    uint32_t timeMs;
+    uint32_t transitions;
+    uint32_t ignored;
+    uint16_t lastLatencyMs;
+    uint16_t maxLatencyMs;
+    uint32_t inputDrops;
+    uint32_t yawRevolutions;
+    int16_t yawLastDrift;
+    uint16_t yawMaxDrift;
+    uint32_t yawSlips;
+    uint32_t telemetryDrops;
+    uint32_t uartDroppedBytes;
+} telemetryDiagnostics_t;
+
+
+/**
+ * @function        telemetryCrc16.
+ * @brief           CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+ * @param data      Bytes to check.
+ * @param length    Number of bytes.
+ * @returns         uint16_t: CRC.
+*/
+uint16_t telemetryCrc16(const uint8_t *data, uint32_t length);
+
+
+/**
+ * @function        cobsEncode.
+ * @brief           Consistent overhead byte stuffing, removes every 0x00 from the data so 0x00 can delimit frames.
+ * @param data      Bytes to encode.
+ * @param length    Number of bytes, up to 254.
+ * @param encoded   Buffer for length + 1 bytes, no delimiter is added.
+ * @returns         uint32_t: Encoded length.
+*/
+uint32_t cobsEncode(const uint8_t *data, uint32_t length, uint8_t *encoded);
+
+
+/**
+ * @function        telemetryEncodeStatus.
+ * @brief           Build a complete TELEMETRY_STATUS frame, ready to send.
+ * @param status    Status to send.
+ * @param sequence  Frame sequence number.
+ * @param frame     Buffer for at least TELEMETRY_MAX_FRAME bytes.
+ * @returns         uint32_t: Frame length, including the delimiters.
+*/
+uint32_t telemetryEncodeStatus(const telemetryStatus_t *status, uint16_t sequence, uint8_t *frame);
+
+
+/**
+ * @function        telemetryEncodeDiagnostics.
+ * @brief           Build a complete TELEMETRY_DIAGNOSTICS frame, ready to send.
+ * @param diag      Counters to send.
+ * @param sequence  Frame sequence number.
+ * @param frame     Buffer for at least TELEMETRY_MAX_FRAME bytes.
+ * @returns         uint32_t: Frame length, including the delimiters.
+*/
+uint32_t telemetryEncodeDiagnostics(const telemetryDiagnostics_t *diag, uint16_t sequence, uint8_t *frame);
+
+#endif /* TELEMETRY_H_ */
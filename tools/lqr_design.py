@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+lqr_design.py
+
+Compute discrete LQR state feedback gains for the main and tail rotors from
+identified second order models (e.g. the wn / zeta / DC gain printed by
+sysid_fit.py) and write them as constant tables in lqrGains.h.
+
+    python3 tools/lqr_design.py --main 2.0,0.7,1.5 --tail 3.0,0.5,2.0 -o lqrGains.h
+
+Each model is G(s) = gain * wn^2 / (s^2 + 2 zeta wn s + wn^2) from duty (%) to
+output (% altitude or degrees). The controller state is
+    x = [y - r, dy/dt, integral of (y - r)]
+and the control law u = trim - K x, where the integral state supplies the trim.
+The plant is discretised with a zero order hold at the control period and the
+discrete algebraic Riccati equation solved by iteration.
+
+The gains are only valid at the rate they were designed for. The main rotor
+controller runs on every ADC sample (ADC_PERIOD_MS, 3 ms) and the tail rotor
+controller in the yaw task (10 ms); the defaults match these, so change
+--main-period / --tail-period together with the firmware.
+
+Plain Python 3, no third party packages needed.
+
+T3 Project Group 6 2021
+"""
+
+import argparse
+import sys
+
+
+def matmul(a, b):
+    return [[sum(a[i][k] * b[k][j] for k in range(len(b))) for j in range(len(b[0]))] for i in range(len(a))]
+
+
+def matadd(a, b, scale=1.0):
+    return [[a[i][j] + scale * b[i][j] for j in range(len(a[0]))] for i in range(len(a))]
+
+
+def transpose(a):
+    return [list(row) for row in zip(*a)]
+
+
+def identity(n):
+    return [[1.0 if i == j else 0.0 for j in range(n)] for i in range(n)]
+
+
+def expm_with_integral(a, b, period, terms=30):
+    """Zero order hold discretisation: Ad = e^(A T), Bd = integral_0^T e^(A s) ds B."""
+    n = len(a)
+    ad = identity(n)
+    integral = [[period if i == j else 0.0 for j in range(n)] for i in range(n)]
+    term = identity(n)
+    for k in range(1, terms):
+        term = [[value * period / k for value in row] for row in matmul(term, a)]
+        ad = matadd(ad, term)
+        integral = matadd(integral, [[value * period / (k + 1) for value in row] for row in term])
+    return ad, matmul(integral, b)
+
+
+def design(wn, zeta, gain, period, q, r):
+    # Continuous plant in [y, dy/dt]
+    a = [[0.0, 1.0], [-wn * wn, -2 * zeta * wn]]
+    b = [[0.0], [gain * wn * wn]]
+    ad, bd = expm_with_integral(a, b, period)
+
+    # Augment with the integral of the output error, z[k+1] = z[k] + T y[k]
+    A = [ad[0] + [0.0], ad[1] + [0.0], [period, 0.0, 1.0]]
+    B = [bd[0], bd[1], [0.0]]
+    Q = [[q[i] if i == j else 0.0 for j in range(3)] for i in range(3)]
+
+    P = [row[:] for row in Q]
+    for _ in range(100000):
+        bt_p = matmul(transpose(B), P)
+        denom = r + matmul(bt_p, B)[0][0]
+        k = [[value / denom for value in matmul(bt_p, A)[0]]]
+        at_p = matmul(transpose(A), P)
+        new_p = matadd(matadd(Q, matmul(at_p, A)), matmul(matmul(at_p, B), k), -1.0)
+        change = max(abs(new_p[i][j] - P[i][j]) for i in range(3) for j in range(3))
+        P = new_p
+        if change < 1e-10:
+            return k[0]
+    sys.exit("Riccati iteration did not converge, check the model and weights")
+
+
+def parse_model(text):
+    try:
+        wn, zeta, gain = (float(value) for value in text.split(","))
+    except ValueError:
+        sys.exit("Model must be wn,zeta,gain e.g. 2.0,0.7,1.5")
+    return wn, zeta, gain
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--main", required=True, help="main rotor model wn,zeta,gain")
+    parser.add_argument("--tail", required=True, help="tail rotor model wn,zeta,gain")
+    parser.add_argument("--main-period", type=float, default=0.003,
+                        help="main rotor control period in s, the ADC sample period (default 0.003)")
+    parser.add_argument("--tail-period", type=float, default=0.01,
+                        help="tail rotor control period in s, the yaw task period (default 0.01)")
+    parser.add_argument("--q", default="1,0.05,0.5", help="state weights error,rate,integral (default 1,0.05,0.5)")
+    parser.add_argument("--r", type=float, default=0.05, help="duty weight (default 0.05)")
+    parser.add_argument("-o", "--output", default="lqrGains.h", help="header to write (default lqrGains.h)")
+    args = parser.parse_args()
+
+    q = [float(value) for value in args.q.split(",")]
+    if len(q) != 3:
+        sys.exit("--q needs three weights")
+
+    models = {"MAIN": parse_model(args.main), "TAIL": parse_model(args.tail)}
+    periods = {"MAIN": args.main_period, "TAIL": args.tail_period}
+    gains = {name: design(*models[name], periods[name], q, args.r) for name in models}
+
+    lines = [
+        "/*",
+        " * lqrGains.h",
+        " *",
+        " * State feedback gains for [error, rate, integral of error], generated by",
+        " * tools/lqr_design.py. Do not edit by hand, re-run the tool instead:",
+        " *",
+        " *   python3 tools/lqr_design.py --main %s --tail %s --main-period %g --tail-period %g --q %s --r %g" % (
+            args.main, args.tail, args.main_period, args.tail_period, args.q, args.r),
+        " *",
+        " * T3 Project Group 6 2021",
+        " */",
+        "",
+        "#ifndef LQRGAINS_H_",
+        "#define LQRGAINS_H_",
+        "",
+    ]
+    for name in ("MAIN", "TAIL"):
+        wn, zeta, gain = models[name]
+        lines.append("// %s rotor model: wn = %g rad/s, zeta = %g, gain = %g, designed for a %g ms control period" % (
+            name.lower(), wn, zeta, gain, periods[name] * 1000))
+        lines.append("#define LQR_%s_GAINS    { %.6ff, %.6ff, %.6ff }" % ((name,) + tuple(gains[name])))
+        lines.append("")
+    lines.append("#endif /* LQRGAINS_H_ */")
+
+    with open(args.output, "w") as header:
+        header.write("\n".join(lines) + "\n")
+    for name in ("MAIN", "TAIL"):
+        print("%s K = [%s]" % (name, ", ".join("%.6f" % value for value in gains[name])))
+
+
+if __name__ == "__main__":
+    main()
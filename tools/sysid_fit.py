@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+sysid_fit.py
+
+Fit a low order model to a system identification log dumped over UART by the
+SYSID flight state (lines between "# sysid ..." and "# end").
+
+    python3 tools/sysid_fit.py capture.txt [--order 2] [--delay 1]
+
+Fits a discrete ARX model from rotor duty to the measured output
+    y[k] = -a1 y[k-1] - ... - an y[k-n] + b1 u[k-d] + ... + bn u[k-d-n+1] + c
+by least squares, and prints its DC gain, poles (order 1 or 2) and (order 2) natural
+frequency and damping. The model is discrete at the log's period_ms: 12 ms for a
+main rotor run (every 4th step of the 3 ms height loop, logged by the height task
+in step with the excitation) and 10 ms for a tail rotor run. Pass the continuous
+wn and zeta, not a and b, to lqr_design.py, which discretises at the loop rate. For a main rotor run it also fits the tail rotor
+torque feedforward (tail duty against main duty and its rate) and prints a
+tail_feedforward initialiser for yaw.c.
+
+Plain Python 3, no third party packages needed.
+
+T3 Project Group 6 2021
+"""
+
+import argparse
+import cmath
+import math
+import sys
+
+
+def read_log(path):
+    """Return (header dict, rows) for the last complete log in a capture."""
+    header = None
+    rows = []
+    logs = []
+    with open(path, errors="replace") as capture:
+        for line in capture:
+            line = line.strip()
+            if line.startswith("# sysid"):
+                header = dict(field.split("=", 1) for field in line[len("# sysid"):].split())
+                rows = []
+            elif line.startswith("# end") and header is not None:
+                logs.append((header, rows))
+                header = None
+            elif header is not None and line and line[0].isdigit():
+                rows.append([int(value) for value in line.split(",")])
+    if not logs:
+        sys.exit("No complete '# sysid' ... '# end' log found in " + path)
+    return logs[-1]
+
+
+def least_squares(rows, targets):
+    """Solve min |A x - b| through the normal equations (A^T A) x = A^T b."""
+    n = len(rows[0])
+    ata = [[sum(row[i] * row[j] for row in rows) for j in range(n)] for i in range(n)]
+    atb = [sum(row[i] * target for row, target in zip(rows, targets)) for i in range(n)]
+    # Gaussian elimination with partial pivoting
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(ata[r][col]))
+        if abs(ata[pivot][col]) < 1e-12:
+            sys.exit("Log does not excite the model enough to fit it (singular normal equations)")
+        ata[col], ata[pivot] = ata[pivot], ata[col]
+        atb[col], atb[pivot] = atb[pivot], atb[col]
+        for r in range(col + 1, n):
+            factor = ata[r][col] / ata[col][col]
+            for c in range(col, n):
+                ata[r][c] -= factor * ata[col][c]
+            atb[r] -= factor * atb[col]
+    x = [0.0] * n
+    for r in reversed(range(n)):
+        x[r] = (atb[r] - sum(ata[r][c] * x[c] for c in range(r + 1, n))) / ata[r][r]
+    return x
+
+
+def poly_roots(a):
+    """Roots of z^n + a1 z^(n-1) + ... + an for n = 1 or 2."""
+    if len(a) == 1:
+        return [complex(-a[0])]
+    disc = cmath.sqrt(a[0] * a[0] - 4 * a[1])
+    return [(-a[0] + disc) / 2, (-a[0] - disc) / 2]
+
+
+def fit_arx(u, y, order, delay):
+    """Least squares ARX fit, returns (a, b, c) with a = [a1..an], b = [b1..bn]."""
+    start = max(order, delay + order - 1)
+    regressors = []
+    targets = []
+    for k in range(start, len(y)):
+        row = [-y[k - i] for i in range(1, order + 1)]
+        row += [u[k - delay - i] for i in range(order)]
+        row.append(1.0)
+        regressors.append(row)
+        targets.append(y[k])
+    theta = least_squares(regressors, targets)
+    return theta[:order], theta[order:2 * order], theta[-1]
+
+
+def describe(a, b, period):
+    den = 1.0 + sum(a)
+    print("  a = [" + ", ".join("%.5f" % value for value in a) + "]")
+    print("  b = [" + ", ".join("%.5f" % value for value in b) + "]")
+    if abs(den) > 1e-9:
+        print("  DC gain = %.4f output units per %% duty" % (sum(b) / den))
+    else:
+        print("  DC gain = inf (integrating)")
+    if len(a) > 2:
+        return
+    poles = poly_roots(a)
+    for pole in poles:
+        print("  z pole %.4f%+.4fj  |z| = %.4f" % (pole.real, pole.imag, abs(pole)))
+    if len(poles) == 2 and all(abs(pole) > 0 for pole in poles):
+        s_poles = [cmath.log(pole) / period for pole in poles]
+        wn = math.sqrt(abs(s_poles[0] * s_poles[1]))
+        if wn > 0:
+            zeta = -(s_poles[0] + s_poles[1]).real / (2 * wn)
+            print("  continuous: wn = %.3f rad/s (%.3f Hz), zeta = %.3f" % (wn, wn / (2 * math.pi), zeta))
+
+
+def fit_feedforward(main, tail, period):
+    """Tail duty = Kbias + Kmain * main + Krate * d(main)/dt."""
+    regressors = []
+    targets = []
+    for k in range(1, len(main) - 1):
+        rate = (main[k + 1] - main[k - 1]) / (2 * period)
+        regressors.append([1.0, main[k], rate])
+        targets.append(tail[k])
+    kbias, kmain, krate = least_squares(regressors, targets)
+    return kbias, kmain, krate
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="UART capture containing a SYSID log")
+    parser.add_argument("--order", type=int, default=2, help="model order (default 2)")
+    parser.add_argument("--delay", type=int, default=1, help="input delay in samples (default 1)")
+    args = parser.parse_args()
+
+    if args.order < 1:
+        sys.exit("--order must be at least 1")
+
+    header, rows = read_log(args.capture)
+    period = float(header.get("period_ms", 10)) / 1000
+    t_ms, main_duty, tail_duty, alt, yaw = ([float(value) for value in column] for column in zip(*rows))
+    axis = header.get("axis", "main")
+
+    print("%s excitation (%s), %d samples, %.0f ms period" % (axis, header.get("signal", "?"), len(rows), period * 1000))
+
+    if axis == "main":
+        u, y, name = main_duty, alt, "altitude (%)"
+    else:
+        u, y, name = tail_duty, yaw, "yaw (degrees)"
+
+    u_mean = sum(u) / len(u)
+    y_mean = sum(y) / len(y)
+    a, b, _ = fit_arx([value - u_mean for value in u], [value - y_mean for value in y], args.order, args.delay)
+    print("Model from %s duty to %s:" % (axis, name))
+    describe(a, b, period)
+
+    if axis == "main":
+        kbias, kmain, krate = fit_feedforward(main_duty, tail_duty, period)
+        print("Tail torque feedforward (yaw.c):")
+        print("    .Kbias = %.3f," % kbias)
+        print("    .Kmain = %.3f," % kmain)
+        print("    .Krate = %.4f," % krate)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+telemetry_decode.py
+
+Decode the binary telemetry frames sent by the UART task (see telemetry.h) from a
+raw serial capture, or live from a serial port.
+
+    python3 tools/telemetry_decode.py capture.bin [--type status|diag] [-o status.csv]
+    python3 tools/telemetry_decode.py --port /dev/ttyACM0 [--type diag]
+
+Frames are COBS encoded between two 0x00 bytes. Each holds a version, a frame type,
+a sequence number, the payload and a CRC-16/CCITT-FALSE. Frames of the selected type
+are written as CSV; anything else in the capture (start up text, SYSID dumps) fails the
+CRC and is skipped. A summary of good, bad and missing frames goes to stderr.
+
+Plain Python 3, no third party packages needed (pyserial only for --port).
+
+T3 Project Group 6 2021
+"""
+
+import argparse
+import struct
+import sys
+
+VERSION = 3
+
+STATES = ["IDLE", "CALIBRATE", "TAKEOFF", "FLYING", "LANDING", "AUTOTUNE", "SYSID"]
+
+# type: (name, struct format of the payload, CSV columns)
+FRAMES = {
+    1: ("status", "<IBBhhhhhhBBiHH",
+        ["time_ms", "state", "flags", "alt", "target_alt", "ref_alt", "yaw", "target_yaw", "ref_yaw",
+         "main", "tail", "raw_alt", "alt_age_ms", "yaw_age_ms"]),
+    2: ("diag", "<IIIHHIIhHIII",
+        ["time_ms", "transitions", "ignored", "latency_ms", "max_latency_ms", "input_drops",
+         "yaw_revs", "yaw_drift", "yaw_max_drift", "yaw_slips", "telemetry_drops",
+         "uart_dropped_bytes"]),
+}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Return the decoded bytes, or None if the block lengths don't fit."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(encoded):
+    """Return (type, sequence, fields) or None for anything that isn't a valid frame."""
+    raw = cobs_decode(encoded)
+    if raw is None or len(raw) < 6:
+        return None
+    body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+    if crc16(body) != crc:
+        return None
+    version, frame_type, sequence = struct.unpack("<BBH", body[:4])
+    if version != VERSION or frame_type not in FRAMES:
+        return None
+    fmt = FRAMES[frame_type][1]
+    if len(body) - 4 != struct.calcsize(fmt):
+        return None
+    fields = list(struct.unpack(fmt, body[4:]))
+    if frame_type == 1:
+        fields[1] = STATES[fields[1]] if fields[1] < len(STATES) else fields[1]
+        fields[5] /= 10.0
+        fields[8] /= 10.0
+    return frame_type, sequence, fields
+
+
+def read_chunks(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--port needs pyserial (pip install pyserial)")
+        port = serial.Serial(args.port, args.baud, timeout=1)
+        while True:
+            yield port.read(256)
+    else:
+        with open(args.capture, "rb") as capture:
+            yield capture.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="raw serial capture file")
+    parser.add_argument("--port", help="read live from this serial port instead")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate (default 115200)")
+    parser.add_argument("--type", choices=["status", "diag"], default="status", help="frames to output (default status)")
+    parser.add_argument("-o", "--output", help="CSV file to write (default stdout)")
+    args = parser.parse_args()
+
+    if not args.capture and not args.port:
+        parser.error("give a capture file or --port")
+
+    wanted = next(frame_type for frame_type, frame in FRAMES.items() if frame[0] == args.type)
+    output = open(args.output, "w") if args.output else sys.stdout
+    output.write(",".join(["seq"] + FRAMES[wanted][2]) + "\n")
+
+    good = bad = missing = 0
+    last_sequence = None
+    pending = b""
+    try:
+        for chunk in read_chunks(args):
+            pending += chunk
+            *blocks, pending = pending.split(b"\x00")
+            for block in blocks:
+                if not block:
+                    continue
+                frame = decode_frame(block)
+                if frame is None:
+                    bad += 1
+                    continue
+                frame_type, sequence, fields = frame
+                good += 1
+                gap = (sequence - last_sequence - 1) & 0xFFFF if last_sequence is not None else 0
+                if gap < 0x8000:
+                    missing += gap      # Otherwise the sequence went backwards, the board was reset
+                last_sequence = sequence
+                if frame_type == wanted:
+                    output.write(",".join(str(value) for value in [sequence] + fields) + "\n")
+            output.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if output is not sys.stdout:
+            output.close()
+        print("%d frames, %d bad or not telemetry, %d missing by sequence number" % (good, bad, missing), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,71 @@
+/*
+ * trajectory.c
+ *
+ * Setpoint trajectory generator. Turns step changes in target altitude / yaw
+ * into smooth S-curve setpoints for the PID loops.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "trajectory.h"
+
+// Clamp value to the range -limit to limit
+static float clampf(float value, float limit) {
+    if (value > limit) {
+        return limit;
+    } else if (value < -limit) {
+        return -limit;
+    }
+    return value;
+}
+
+void trajectoryReset(trajectory_t *traj, float position) {
+    uint8_t i;
+
+    traj->profile = position;
+    traj->velocity = 0;
+    traj->position = position;
+    for (i = 0; i < traj->jerkTicks; i++) {
+        traj->window[i] = position;
+    }
+    traj->sum = position * traj->jerkTicks;
+    traj->index = 0;
+}
+
+float trajectoryUpdate(trajectory_t *traj, float target, float period) {
+    float error = target - traj->profile;
+    float dv = traj->maxAcc * period;
+
+    /* Fastest rate that still stops exactly on the target when decelerating by dv
+       each tick (discrete form of v = sqrt(2 a d), avoids chattering at the end) */
+    float stopVel = dv * (sqrtf(0.25f + 2 * fabsf(error) / (dv * period)) - 0.5f);
+    float desiredVel = clampf((error < 0) ? -stopVel : stopVel, traj->maxVel);
+
+    traj->velocity += clampf(desiredVel - traj->velocity, dv);
+    traj->profile += traj->velocity * period;
+
+    // Settle onto the target once within one tick of travel at the final approach speed
+    if (fabsf(target - traj->profile) <= dv * period && fabsf(traj->velocity) <= dv) {
+        traj->profile = target;
+        traj->velocity = 0;
+    }
+
+    // Moving average over jerkTicks turns the trapezoid into an S-curve
+    traj->sum += traj->profile - traj->window[traj->index];
+    traj->window[traj->index] = traj->profile;
+    traj->index++;
+    if (traj->index >= traj->jerkTicks) {
+        uint8_t i;
+        // Recalculate the sum once per window so float rounding can't build up
+        traj->index = 0;
+        traj->sum = 0;
+        for (i = 0; i < traj->jerkTicks; i++) {
+            traj->sum += traj->window[i];
+        }
+    }
+    traj->position = traj->sum / traj->jerkTicks;
+    return traj->position;
+}
@@ -0,0 +1,67 @@
+/*
+ * trajectory.h
+ *
+ * Header for trajectory.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <stdint.h>
+
+#define TRAJ_SMOOTH_MAX     32      // Longest S-curve smoothing window (ticks)
+
+/**
+ * @struct              trajectory_t.
+ * @brief               Contains a rate, acceleration and jerk limited setpoint for one axis.
+ * @brief               Limits are set once, the profile state is updated every control tick.
+ *
+ * @param maxVel        Maximum setpoint rate (units / s).
+ * @param maxAcc        Maximum setpoint acceleration (units / s^2).
+ * @param jerkTicks     Length of the S-curve smoothing window in ticks (1 to TRAJ_SMOOTH_MAX).
+ *                      Acceleration ramps over this window, so jerk = maxAcc / (jerkTicks * period).
+ * @param profile       Rate and acceleration limited (trapezoidal) position before smoothing.
+ * @param velocity      Current trapezoidal profile rate.
+ * @param position      Current smoothed setpoint, passed to the PID controller.
+ * @param window        Last jerkTicks profile positions, averaged to give position.
+ * @param sum           Sum of window.
+ * @param index         Next window entry to overwrite.
+*/
+typedef struct _trajectory_t {
+    const float maxVel;
+    const float maxAcc;
+    const uint8_t jerkTicks;
+    float profile;
+    float velocity;
+    float position;
+    float window[TRAJ_SMOOTH_MAX];
+    float sum;
+    uint8_t index;
+} trajectory_t;
+
+
+/**
+ * @function        trajectoryReset.
+ * @brief           Place the setpoint at a position at rest, e.g. the measured value before takeoff.
+ * @param traj      Pointer to a trajectory structure.
+ * @param position  Position to start from.
+*/
+void trajectoryReset(trajectory_t *traj, float position);
+
+
+/**
+ * @function        trajectoryUpdate.
+ * @brief           Advance the setpoint one tick towards the target without exceeding the rate, acceleration or jerk limits,
+ *                  braking early enough to stop on the target without overshoot.
+ * @brief           A trapezoidal profile is generated first then averaged over jerkTicks, which rounds its corners
+ *                  into an S-curve and, as an average, can never pass the target.
+ * @param traj      Pointer to a trajectory structure.
+ * @param target    Commanded target value.
+ * @param period    Time since the last update (s).
+ * @returns         float: New smoothed setpoint.
+*/
+float trajectoryUpdate(trajectory_t *traj, float target, float period);
+
+#endif /* TRAJECTORY_H_ */
@@ -2,7 +2,7 @@
  *  uart.c
  *
  *  Definition of UART tasks
- *	Sends helirig data over serial communications
+ *	Sends helirig telemetry over serial communications as binary frames (see telemetry.h)
  *
  *  T3 Project Group 6 2021
  */
@@ -33,11 +33,25 @@
 #include "semphr.h"
 #include "task.h"
 
+#include "bus.h"
+#include "fsm.h"
 #include "priorities.h"
 #include "shared.h"
+#include "sysid.h"
+#include "telemetry.h"
+#include "uartTx.h"
+#include "userInputs.h"
+#include "yaw.h"
 
+#define TELEMETRY_PERIOD_MS     20  // Status frame period, one frame is 37 bytes (3.2 ms at 115200 baud)
+#define TELEMETRY_DIAG_FRAMES   25  // Status frames per diagnostics frame (every 500 ms)
+#define SYSID_DUMP_LINES        8   // Identification log lines sent per UART task period (~40% of the link)
+#define SYSID_LINE_MAX          48  // Transmit buffer space needed before sending a log line, so none are dropped
 
-extern systemState systemStatus;
+
+extern yawDriftStats_t g_yawDrift;
+
+extern fsm_t g_flightFsm;
 
 xSemaphoreHandle g_UARTMutex;
 
@@ -58,29 +72,139 @@ void configUART (void) {
 
     //UART transmission settings
     UARTStdioConfig(0, 115200, 16000000);
+
+    //Send through the uDMA transmit buffer so printing never waits for the UART
+    initUartTx();
+}
+
+// Telemetry frame sequence number and frames skipped because the transmit buffer was full
+static uint16_t g_telemetrySequence = 0;
+static uint32_t g_telemetryDrops = 0;
+
+/* Queue a frame for the UART. UARTwrite would turn every 0x0A into "\r\n".
+   The frame goes in whole so text from other tasks can't split it, and needs no mutex.
+   Dropped frames still use up a sequence number so the receiver can count them. */
+static void sendFrame(const uint8_t *frame, uint32_t length) {
+    if (!uartTxWrite(frame, length)) {
+        g_telemetryDrops++;
+    }
+    g_telemetrySequence++;
+}
+
+// Time since a topic was published in ms, saturating at the telemetry field size
+static uint16_t topicAgeMs(topic_t topic, uint32_t now) {
+    uint32_t age = busAge(topic, now) * portTICK_RATE_MS;
+    return age > UINT16_MAX ? UINT16_MAX : age;
+}
+
+/*send system status through UART*/
+static void sendStatus(void) {
+    systemState status;
+    telemetryStatus_t telemetry;
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    uint32_t ui32Now = xTaskGetTickCount();
+    readSystemState(&status);
+
+    telemetry.timeMs = ui32Now * portTICK_RATE_MS;
+    telemetry.state = status.flight.state;
+    telemetry.systemOn = status.input.system_on;
+    telemetry.yawCalibrated = status.flight.yawCalibrated;
+    telemetry.alt = status.alt.currentAltPercent;
+    telemetry.targetAlt = status.flight.targetAlt;
+    telemetry.refAlt = status.flight.refAlt;
+    telemetry.yaw = status.yaw.currentYawDegrees;
+    telemetry.targetYaw = status.flight.targetYaw;
+    telemetry.refYaw = status.flight.refYaw;
+    telemetry.mainDuty = status.mainPWMDuty;
+    telemetry.tailDuty = status.tailPWMDuty;
+    telemetry.rawAlt = status.alt.currentAlt;
+    telemetry.altAgeMs = topicAgeMs(TOPIC_ALTITUDE, ui32Now);
+    telemetry.yawAgeMs = topicAgeMs(TOPIC_YAW, ui32Now);
+
+    sendFrame(frame, telemetryEncodeStatus(&telemetry, g_telemetrySequence, frame));
+}
+
+/*send event and error counters through UART*/
+static void sendDiagnostics(void) {
+    telemetryDiagnostics_t diag;
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+
+    diag.timeMs = xTaskGetTickCount() * portTICK_RATE_MS;
+    diag.transitions = g_flightFsm.transitions;
+    diag.ignored = g_flightFsm.ignored;
+    diag.lastLatencyMs = g_flightFsm.lastLatency * portTICK_RATE_MS;
+    diag.maxLatencyMs = g_flightFsm.maxLatency * portTICK_RATE_MS;
+    diag.inputDrops = inputDrops();
+    diag.yawRevolutions = g_yawDrift.revolutions;
+    diag.yawLastDrift = g_yawDrift.lastDrift;
+    diag.yawMaxDrift = g_yawDrift.maxDrift;
+    diag.yawSlips = g_yawDrift.slips;
+    diag.telemetryDrops = g_telemetryDrops;
+    diag.uartDroppedBytes = uartTxDroppedBytes();
+
+    sendFrame(frame, telemetryEncodeDiagnostics(&diag, g_telemetrySequence, frame));
 }
 
-/*print system information to through UART*/
-void printStatus(void) {
+// Identification log dump progress
+static uint32_t g_sysidDumpedRuns = 0;
+static uint32_t g_sysidDumpIndex;
+static bool g_sysidDumping = false;
+
+/* Start dumping the identification log as CSV when a new run has finished */
+static void startSysidDump(void) {
+    g_sysidDumpedRuns = sysidRunCount();
+    g_sysidDumpIndex = 0;
+    g_sysidDumping = true;
+
     xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
-    UARTprintf("\r\nSystem state:\t%s\r\n", statesLookup[systemStatus.state]);
-    UARTprintf("Altitude:\t%02d%% [%02d%%]\r\n", systemStatus.currentAltPercent, systemStatus.targetAlt);
-    UARTprintf("Yaw:\t%03d%c [%03d%c]\r\n", systemStatus.currentYawDegrees, 176, systemStatus.targetYaw, 176);
-    UARTprintf("Duty cycle: Main: %d%%, Tail: %d%%\r\n", systemStatus.mainPWMDuty, systemStatus.tailPWMDuty);
-    UARTprintf("System on: %d\r\n", systemStatus.system_on);
+    UARTprintf("\r\n# sysid axis=%s signal=%s samples=%d period_ms=%d\r\n",
+               sysidAxis() == SYSID_MAIN ? "main" : "tail",
+               sysidSignalType() == SYSID_PRBS ? "prbs" : "chirp",
+               sysidLogCount(), sysidLogPeriodMs());
+    UARTprintf("t_ms,main,tail,alt,yaw\r\n");
     xSemaphoreGive(g_UARTMutex);
 }
 
+/* Send the next SYSID_DUMP_LINES lines of the log, a line at a time so other tasks can still print.
+   Lines wait for the next period rather than be dropped when the transmit buffer is getting full. */
+static void dumpSysidLog(void) {
+    uint32_t ui32Lines;
+
+    for (ui32Lines = 0; ui32Lines < SYSID_DUMP_LINES && g_sysidDumpIndex < sysidLogCount() && uartTxFree() >= SYSID_LINE_MAX; ui32Lines++) {
+        const sysidSample_t *sample = sysidLogSample(g_sysidDumpIndex++);
+        xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
+        UARTprintf("%d,%d,%d,%d,%d\r\n", sample->timeMs, sample->mainDuty, sample->tailDuty, sample->alt, sample->yaw);
+        xSemaphoreGive(g_UARTMutex);
+    }
+    if (g_sysidDumpIndex >= sysidLogCount() && uartTxFree() >= SYSID_LINE_MAX) {
+        xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
+        UARTprintf("# end\r\n");
+        xSemaphoreGive(g_UARTMutex);
+        g_sysidDumping = false;
+    }
+}
+
 static void uartTask (void *pvParameters) {
 
   //set up some Parameters
     portTickType ui16LastTime;
-    uint32_t ui32PollDelay = 250;
+    uint32_t ui32Frames = 0;
     ui16LastTime = xTaskGetTickCount();
 
     while(1) {
-        printStatus(); //Call the print function to print system information for testing
-        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
+        if (!g_sysidDumping && sysidRunCount() != g_sysidDumpedRuns) {
+            startSysidDump();
+        }
+        if (g_sysidDumping) {
+            dumpSysidLog(); //Identification log takes over the UART until it has been sent
+        } else {
+            sendStatus();
+            if (++ui32Frames >= TELEMETRY_DIAG_FRAMES) {
+                ui32Frames = 0;
+                sendDiagnostics();
+            }
+        }
+        vTaskDelayUntil(&ui16LastTime, TELEMETRY_PERIOD_MS / portTICK_RATE_MS);
         // Wait for the required amount of tick, ensure a constant execution frequency
     }
 }
@@ -18,7 +18,7 @@ void configUART (void);
 
 /**
  * @function            uartTask.
- * @brief               uartTask to be scheduled by FreeRTOS, sends system status information over UART to PC.
+ * @brief               uartTask to be scheduled by FreeRTOS, sends binary status and diagnostics telemetry frames over UART to PC.
  * @param pvParameters  Pointer to task parameters (NULL).
 */
 static void uartTask(void* pvParameters);
@@ -0,0 +1,159 @@
+/*
+ * uartTx.c
+ *
+ * Non-blocking UART0 transmit. Writers copy into a ring buffer and return, uDMA
+ * feeds the buffer to the UART and the UART0 interrupt starts each transfer, so
+ * no task waits for the serial port.
+ *
+ * Writers claim space with a compare and swap on one word holding both the
+ * reserve index and the number of writers still copying. The writer that brings
+ * that count back to zero knows everything reserved so far has been copied and
+ * publishes it to the interrupt, the only reader.
+ *
+ * T3 Project Group 6 2021
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+
+#include "FreeRTOS.h"
+
+#include "uartTx.h"
+
+#define INDEX_MASK      (UART_TX_BUFFER_SIZE - 1)
+#define WRITER          0x10000     // One writer in g_txReserve, the low 16 bits are the reserve index
+
+static uint8_t g_txBuffer[UART_TX_BUFFER_SIZE];
+
+// Indexes are free running 16 bit counts, masked to address the buffer
+static volatile uint32_t g_txReserve = 0;   // Writers copying << 16 | end of the reserved bytes
+static volatile uint32_t g_txCommit = 0;    // End of the bytes ready to send
+static volatile uint16_t g_txTail = 0;      // Start of the bytes not yet sent, only moved by the interrupt
+static uint16_t g_txSending = 0;            // Length of the transfer in progress
+
+static volatile uint32_t g_txDroppedBytes = 0;
+
+// Atomically replace the value at word with desired if it still holds expected
+static bool compareAndSwap(volatile uint32_t *word, uint32_t expected, uint32_t desired) {
+#if defined(__TI_COMPILER_VERSION__)
+    if (__ldrex((void *)word) != expected) {
+        return false;
+    }
+    return __strex(desired, (void *)word) == 0;
+#else
+    return __sync_bool_compare_and_swap(word, expected, desired);
+#endif
+}
+
+// Move the commit index forward to end, unless a later writer has already moved it further
+static void publish(uint16_t end) {
+    uint32_t commit;
+
+    do {
+        commit = g_txCommit;
+        if ((int16_t)(end - commit) <= 0) {
+            return;
+        }
+    } while (!compareAndSwap(&g_txCommit, commit, end));
+}
+
+// Count bytes that did not fit, any number of writers may be dropping at once
+static void addDropped(uint32_t length) {
+    uint32_t dropped;
+
+    do {
+        dropped = g_txDroppedBytes;
+    } while (!compareAndSwap(&g_txDroppedBytes, dropped, dropped + length));
+}
+
+void initUartTx(void) {
+    uDMAChannelAssign(UDMA_CH9_UART0TX);
+    uDMAChannelAttributeDisable(UDMA_CH9_UART0TX, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(UDMA_CH9_UART0TX | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+
+    // Burst requests once half the transmit FIFO is empty
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    UARTDMAEnable(UART0_BASE, UART_DMA_TX);
+
+    UARTIntRegister(UART0_BASE, uartTxIntHandler);
+    IntPrioritySet(INT_UART0, configKERNEL_INTERRUPT_PRIORITY);
+}
+
+bool uartTxWrite(const void *data, uint32_t length) {
+    const uint8_t *bytes = data;
+    uint32_t word;
+    uint16_t index;
+    uint32_t i;
+
+    do {
+        word = g_txReserve;
+        index = word;
+        if (length > (uint32_t)(UART_TX_BUFFER_SIZE - (uint16_t)(index - g_txTail))) {
+            addDropped(length);
+            return false;
+        }
+    } while (!compareAndSwap(&g_txReserve, word, ((word & ~0xFFFF) + WRITER) | (uint16_t)(index + length)));
+
+    for (i = 0; i < length; i++) {
+        g_txBuffer[(uint16_t)(index + i) & INDEX_MASK] = bytes[i];
+    }
+
+    do {
+        word = g_txReserve;
+    } while (!compareAndSwap(&g_txReserve, word, word - WRITER));
+
+    // Last writer out, every byte reserved up to this point has been copied
+    if (word < 2 * WRITER) {
+        publish(word);
+        IntPendSet(INT_UART0);
+    }
+    return true;
+}
+
+uint32_t uartTxFree(void) {
+    return UART_TX_BUFFER_SIZE - (uint16_t)((uint16_t)g_txReserve - g_txTail);
+}
+
+uint32_t uartTxDroppedBytes(void) {
+    return g_txDroppedBytes;
+}
+
+void uartTxIntHandler(void) {
+    uint16_t waiting;
+    uint16_t start;
+
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+
+    // Pended by a writer while a transfer is still running, its completion will pick the new bytes up
+    if (uDMAChannelModeGet(UDMA_CH9_UART0TX | UDMA_PRI_SELECT) != UDMA_MODE_STOP) {
+        return;
+    }
+
+    g_txTail += g_txSending;
+    g_txSending = 0;
+
+    waiting = (uint16_t)g_txCommit - g_txTail;
+    if (waiting == 0) {
+        return;
+    }
+
+    // Stop at the end of the buffer, the rest goes in the next transfer
+    start = g_txTail & INDEX_MASK;
+    if (waiting > UART_TX_BUFFER_SIZE - start) {
+        waiting = UART_TX_BUFFER_SIZE - start;
+    }
+
+    g_txSending = waiting;
+    uDMAChannelTransferSet(UDMA_CH9_UART0TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                           &g_txBuffer[start], (void *)(UART0_BASE + UART_O_DR), waiting);
+    uDMAChannelEnable(UDMA_CH9_UART0TX);
+}
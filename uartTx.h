@@ -0,0 +1,58 @@
+/*
+ * uartTx.h
+ *
+ * Header for uartTx.c
+ *
+ * T3 Project Group 6 2021
+ */
+
+#ifndef UARTTX_H_
+#define UARTTX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_TX_BUFFER_SIZE     1024    // Power of two, at most 1024 so any contiguous run fits one uDMA transfer
+
+/**
+ * @function        initUartTx.
+ * @brief           Send UART0 output from a ring buffer by uDMA channel 9, started again from the UART0 interrupt
+ *                  each time a transfer completes. UART0 and the uDMA controller must already be set up.
+*/
+void initUartTx(void);
+
+
+/**
+ * @function        uartTxWrite.
+ * @brief           Queue bytes for sending without waiting for the UART. Lock free, any number of tasks may write
+ *                  at once and each write is sent whole and uninterrupted by other writes.
+ * @brief           If the buffer does not have room for all of them nothing is queued and the bytes are counted as dropped.
+ * @param data      Bytes to send.
+ * @param length    Number of bytes.
+ * @returns         bool: true if the bytes were queued.
+*/
+bool uartTxWrite(const void *data, uint32_t length);
+
+
+/**
+ * @function        uartTxFree.
+ * @brief           Space left in the buffer. Another task may use it before the caller does.
+ * @returns         uint32_t: Bytes that can currently be queued.
+*/
+uint32_t uartTxFree(void);
+
+
+/**
+ * @function        uartTxDroppedBytes.
+ * @returns         uint32_t: Bytes not sent because the buffer was full.
+*/
+uint32_t uartTxDroppedBytes(void);
+
+
+/**
+ * @function        uartTxIntHandler.
+ * @brief           UART0 interrupt. Moves past the finished transfer and starts the next one. Also pended by uartTxWrite.
+*/
+void uartTxIntHandler(void);
+
+#endif /* UARTTX_H_ */
@@ -36,6 +36,7 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
 #include "utils/uartstdio.h"
+#include "uartTx.h"
 
 //*****************************************************************************
 //
@@ -133,6 +134,76 @@ static uint32_t g_ui32Base = 0;
 //*****************************************************************************
 static const char * const g_pcHex = "0123456789abcdef";
 
+#ifndef UART_BUFFERED
+//*****************************************************************************
+//
+// The output of one UARTwrite() or UARTprintf() call, CRLF translated and
+// queued with a single uartTxWrite() so it is sent or dropped whole and no
+// other writer's output lands in the middle of it.  Calls longer than the
+// line buffer (none in this project) are queued a line buffer at a time.
+//
+//*****************************************************************************
+#define UART_LINE_SIZE          96
+
+typedef struct
+{
+    char pcBuf[UART_LINE_SIZE];
+    uint32_t ui32Len;
+}
+tUARTLine;
+
+//*****************************************************************************
+//
+// Queue the line built so far and start a new one.
+//
+//*****************************************************************************
+static void
+UARTLineFlush(tUARTLine *psLine)
+{
+    if(psLine->ui32Len > 0)
+    {
+        uartTxWrite(psLine->pcBuf, psLine->ui32Len);
+        psLine->ui32Len = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Add characters to the line, translating \n to \r\n.
+//
+//*****************************************************************************
+static void
+UARTLineAdd(tUARTLine *psLine, const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        //
+        // Only a call longer than the line buffer gets here with it full.
+        //
+        if(psLine->ui32Len > sizeof(psLine->pcBuf) - 2)
+        {
+            UARTLineFlush(psLine);
+        }
+        if(pcBuf[ui32Idx] == '\n')
+        {
+            psLine->pcBuf[psLine->ui32Len++] = '\r';
+        }
+        psLine->pcBuf[psLine->ui32Len++] = pcBuf[ui32Idx];
+    }
+}
+#else
+//*****************************************************************************
+//
+// In buffered mode UARTprintf() writes each piece to the transmit buffer.
+//
+//*****************************************************************************
+#define UARTLineAdd(psLine, pcBuf, ui32Len)                                   \
+                                UARTwrite(pcBuf, ui32Len)
+#define UARTLineFlush(psLine)
+#endif
+
 //*****************************************************************************
 //
 // The list of possible base addresses for the console UART.
@@ -423,8 +494,9 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
 //! a null character (0) is encountered, then no more characters will be
 //! transmitted and the function will return.
 //!
-//! In non-buffered mode, this function is blocking and will not return until
-//! all the characters have been written to the output FIFO.  In buffered mode,
+//! In non-buffered mode, the translated characters are queued in one piece for
+//! uDMA to send (see uartTx.c) and the call returns immediately.  If they do
+//! not fit in the transmit buffer they are all discarded.  In buffered mode,
 //! the characters are written to the UART transmit buffer and the call returns
 //! immediately.  If insufficient space remains in the transmit buffer,
 //! additional characters are discarded.
@@ -501,7 +573,7 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     //
     return(uIdx);
 #else
-    unsigned int uIdx;
+    tUARTLine sLine;
 
     //
     // Check for valid UART base address, and valid arguments.
@@ -510,29 +582,16 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     ASSERT(pcBuf != 0);
 
     //
-    // Send the characters
+    // Translate the characters and queue them in one piece.
     //
-    for(uIdx = 0; uIdx < ui32Len; uIdx++)
-    {
-        //
-        // If the character to the UART is \n, then add a \r before it so that
-        // \n is translated to \n\r in the output.
-        //
-        if(pcBuf[uIdx] == '\n')
-        {
-            MAP_UARTCharPut(g_ui32Base, '\r');
-        }
-
-        //
-        // Send the character to the UART output.
-        //
-        MAP_UARTCharPut(g_ui32Base, pcBuf[uIdx]);
-    }
+    sLine.ui32Len = 0;
+    UARTLineAdd(&sLine, pcBuf, ui32Len);
+    UARTLineFlush(&sLine);
 
     //
     // Return the number of characters written.
     //
-    return(uIdx);
+    return(ui32Len);
 #endif
 }
 
@@ -853,6 +912,10 @@ UARTgetc(void)
 //! requirements of the format string.  For example, if an integer was passed
 //! where a string was expected, an error of some kind will most likely occur.
 //!
+//! In non-buffered mode the whole of the output is formatted first and queued
+//! in one piece, so it is sent or dropped as a unit and other writers' output
+//! never lands in the middle of it.
+//!
 //! \return None.
 //
 //*****************************************************************************
@@ -861,6 +924,11 @@ UARTvprintf(const char *pcString, va_list vaArgP)
 {
     uint32_t ui32Idx, ui32Value, ui32Pos, ui32Count, ui32Base, ui32Neg;
     char *pcStr, pcBuf[16], cFill;
+#ifndef UART_BUFFERED
+    tUARTLine sLine;
+
+    sLine.ui32Len = 0;
+#endif
 
     //
     // Check the arguments.
@@ -884,7 +952,7 @@ UARTvprintf(const char *pcString, va_list vaArgP)
         //
         // Write this portion of the string.
         //
-        UARTwrite(pcString, ui32Idx);
+        UARTLineAdd(&sLine, pcString, ui32Idx);
 
         //
         // Skip the portion of the string that was written.
@@ -968,7 +1036,7 @@ again:
                     //
                     // Print out the character.
                     //
-                    UARTwrite((char *)&ui32Value, 1);
+                    UARTLineAdd(&sLine, (char *)&ui32Value, 1);
 
                     //
                     // This command has been handled.
@@ -1048,7 +1116,7 @@ again:
                     //
                     // Write the string.
                     //
-                    UARTwrite(pcStr, ui32Idx);
+                    UARTLineAdd(&sLine, pcStr, ui32Idx);
 
                     //
                     // Write any required padding spaces
@@ -1058,7 +1126,7 @@ again:
                         ui32Count -= ui32Idx;
                         while(ui32Count--)
                         {
-                            UARTwrite(" ", 1);
+                            UARTLineAdd(&sLine, " ", 1);
                         }
                     }
 
@@ -1206,7 +1274,7 @@ convert:
                     //
                     // Write the string.
                     //
-                    UARTwrite(pcBuf, ui32Pos);
+                    UARTLineAdd(&sLine, pcBuf, ui32Pos);
 
                     //
                     // This command has been handled.
@@ -1222,7 +1290,7 @@ convert:
                     //
                     // Simply write a single %.
                     //
-                    UARTwrite(pcString - 1, 1);
+                    UARTLineAdd(&sLine, pcString - 1, 1);
 
                     //
                     // This command has been handled.
@@ -1238,7 +1306,7 @@ convert:
                     //
                     // Indicate an error.
                     //
-                    UARTwrite("ERROR", 5);
+                    UARTLineAdd(&sLine, "ERROR", 5);
 
                     //
                     // This command has been handled.
@@ -1248,6 +1316,11 @@ convert:
             }
         }
     }
+
+    //
+    // Queue the whole of the output in one piece.
+    //
+    UARTLineFlush(&sLine);
 }
 
 //*****************************************************************************
@@ -9,12 +9,15 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/debug.h"
+#include "driverlib/timer.h"
 #include "inc/tm4c123gh6pm.h"
 
 #include "FreeRTOS.h"
@@ -23,15 +26,48 @@
 #include "semphr.h"
 #include "utils/uartstdio.h"
 
+#include "bus.h"
+#include "control.h"
+#include "debounce.h"
 #include "priorities.h"
 #include "shared.h"
 #include "userInputs.h"
 #include "uart.h"
 
-extern systemState systemStatus;
+// Switch state published for the other tasks, this task is its only writer
+static inputStatus_t g_inputStatus;
 
 xQueueHandle g_InputQueue;
 
+static xTaskHandle g_inputsTaskHandle = NULL;
+
+// Input events dropped because the queue was full
+static volatile uint32_t g_inputDrops = 0;
+
+// Pairs of buttons pressed together for the chord events
+static const uint32_t g_chords[] = {
+    INPUT_UP | INPUT_DOWN,
+    INPUT_LEFT | INPUT_RIGHT
+};
+
+// Chord input device IDs and names for the UART, in the same order as g_chords
+static const uint8_t g_chordIDs[] = {
+    UP_DOWN_CHORD,
+    LEFT_RIGHT_CHORD
+};
+static const char * const g_chordNames[] = {"Up + Down", "Left + Right"};
+
+static debounce_t g_debounce = {
+    .repeatMask = INPUT_BUTTONS,
+    .longSamples = INPUT_LONG_PRESS_MS / INPUT_SAMPLE_MS,
+    .repeatSamples = INPUT_REPEAT_MS / INPUT_SAMPLE_MS,
+    .chords = g_chords,
+    .numChords = sizeof(g_chords) / sizeof(g_chords[0])
+};
+
+// Button names for the UART, in input bit order
+static const char * const g_buttonNames[] = {"Left", "Right", "Up", "Down"};
+
 extern xSemaphoreHandle g_UARTMutex;
 xSemaphoreHandle g_PrintSemaphore;
 
@@ -42,12 +78,6 @@ xSemaphoreHandle g_PrintSemaphore;
 
 // LEFT button (Tiva Launchpad)
 static userInput_t g_left_button = {
-    .is_button = true,
-    .is_portf = true,
-    .status = false,
-    .current_button_state = false,
-    .input_event = NONE,
-    .debounce_counter = 0,
     .periph = LEFT_BUT_PERIPH,
     .port_base = LEFT_BUT_PORT_BASE,
     .pin = LEFT_BUT_PIN,
@@ -57,13 +87,7 @@ static userInput_t g_left_button = {
 
 // RIGHT button (Tiva Launchpad)
 static userInput_t g_right_button = {
-    .is_button = true,
-    .is_portf = true,
     .is_right_button = true,
-    .status = false,
-    .current_button_state = false,
-    .input_event = NONE,
-    .debounce_counter = 0,
     .periph = RIGHT_BUT_PERIPH,
     .port_base = RIGHT_BUT_PORT_BASE,
     .pin = RIGHT_BUT_PIN,
@@ -73,11 +97,6 @@ static userInput_t g_right_button = {
 
 // UP button (Orbit Boosterpack)
 static userInput_t g_up_button = {
-    .is_button = true,
-    .status = false,
-    .current_button_state = false,
-    .input_event = NONE,
-    .debounce_counter = 0,
     .periph = UP_BUT_PERIPH,
     .port_base = UP_BUT_PORT_BASE,
     .pin = UP_BUT_PIN,
@@ -87,11 +106,6 @@ static userInput_t g_up_button = {
 
 // DOWN button (Orbit Boosterpack)
 static userInput_t g_down_button = {
-    .is_button = true,
-    .status = false,
-    .current_button_state = false,
-    .input_event = NONE,
-    .debounce_counter = 0,
     .periph = DOWN_BUT_PERIPH,
     .port_base = DOWN_BUT_PORT_BASE,
     .pin = DOWN_BUT_PIN,
@@ -108,6 +122,20 @@ static userInput_t g_right_switch = {
     .gpio_pin_type = RIGHT_SW_GPIO_PIN_TYPE
 };
 
+// All input objects, for the functions that set up every input
+static userInput_t * const g_inputObjs[] = {
+    &g_left_button,
+    &g_right_button,
+    &g_up_button,
+    &g_down_button,
+    &g_right_switch
+};
+
+#define NUM_INPUT_OBJS (sizeof(g_inputObjs) / sizeof(g_inputObjs[0]))
+
+// Input bit for a pin in a port read
+#define PIN_TO_INPUT(port, pin, input)  (((port) & (pin)) ? (input) : 0)
+
 void initInputObj(userInput_t *inputObj) {
     SysCtlPeripheralEnable(inputObj->periph);
 
@@ -122,160 +150,205 @@ void initInputObj(userInput_t *inputObj) {
 
     GPIOPinTypeGPIOInput(inputObj->port_base, inputObj->pin);
     GPIOPadConfigSet(inputObj->port_base, inputObj->pin, inputObj->gpio_strength, inputObj->gpio_pin_type);
+}
+
+/* Read every input with one read per port, packed into the INPUT_ bits with 1 = active.
+   Left / Right buttons are active low, Up / Down and the switch are active high. */
+uint32_t sampleInputs(void) {
+    uint32_t ui32PortA = GPIOPinRead(RIGHT_SW_PORT_BASE, RIGHT_SW_PIN);
+    uint32_t ui32PortD = GPIOPinRead(DOWN_BUT_PORT_BASE, DOWN_BUT_PIN);
+    uint32_t ui32PortE = GPIOPinRead(UP_BUT_PORT_BASE, UP_BUT_PIN);
+    uint32_t ui32PortF = ~GPIOPinRead(LEFT_BUT_PORT_BASE, LEFT_BUT_PIN | RIGHT_BUT_PIN);
+
+    return PIN_TO_INPUT(ui32PortF, LEFT_BUT_PIN, INPUT_LEFT)
+         | PIN_TO_INPUT(ui32PortF, RIGHT_BUT_PIN, INPUT_RIGHT)
+         | PIN_TO_INPUT(ui32PortE, UP_BUT_PIN, INPUT_UP)
+         | PIN_TO_INPUT(ui32PortD, DOWN_BUT_PIN, INPUT_DOWN)
+         | PIN_TO_INPUT(ui32PortA, RIGHT_SW_PIN, INPUT_SWITCH);
+}
 
-    if (!(inputObj->is_button)) {
-        systemStatus.system_on = GPIOPinRead(inputObj->port_base, inputObj->pin) != 0;
+void initInputs(void) {
+    uint32_t i;
+
+    for (i = 0; i < NUM_INPUT_OBJS; i++) {
+        initInputObj(g_inputObjs[i]);
     }
+
+    // Start from the current levels, only changes after this produce events
+    initDebounce(&g_debounce, sampleInputs());
+    g_inputStatus.system_on = (g_debounce.state & INPUT_SWITCH) != 0;
+    busPublish(TOPIC_INPUTS, &g_inputStatus);
 }
 
-// Check state of button object, return true if button pressed
-bool checkButtonState(userInput_t *inputObj) {
-    bool state = false;
-    // Set button pressed state to true if button PUSHED event occurs
-    if((inputObj->was_pressed) && (inputObj->input_event) == PUSHED) state = true;
-    inputObj->was_pressed = false;
-    return state;
+// Sample the inputs every INPUT_SAMPLE_MS until they are idle again
+static void startSampling(void) {
+    uint32_t i;
+
+    for (i = 0; i < NUM_INPUT_OBJS; i++) {
+        GPIOIntDisable(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
+    }
+    TimerEnable(TIMER1_BASE, TIMER_A);
 }
 
-void updateInputObj(userInput_t *inputObj) {
-    // Read GPIO pin for specified input object and store in object->status
-    inputObj->status = GPIOPinRead(inputObj->port_base, inputObj->pin);
-
-    // Logic for if inputObj is a button as updateInputObj handles both button and switch inputs
-    if (inputObj->is_button) {
-
-        // If new button status does not match stored current button state, proceed with update to new state
-        if (inputObj->status != inputObj->current_button_state) {
-            // Increment the debounce counter
-            inputObj->debounce_counter++;
-
-            // Ignore new button presses if debouncing threshold <= 10
-            if(inputObj->debounce_counter >= 10) {
-                // Update stored button state to new button status
-                inputObj->current_button_state = inputObj->status;
-                // Reset debounce counter
-                inputObj->debounce_counter = 0;
-
-                // Determine what button event has occurred for left and right buttons on portf of the Tiva
-                if(inputObj->is_portf) {
-                    // Set default button pressed status to NONE (no change)
-                    inputObj->input_event = NONE;
-
-                    // Left / Right buttons are active low (set inputObj->pressed to PUSHED if current state == 0, RELEASED if current state == 1)
-                    inputObj->input_event = inputObj->current_button_state ? RELEASED : PUSHED;
-                }
-                else {
-                // Determine what button event has occurred for up and down buttons on portd / porte of the Tiva
-                    inputObj->input_event = NONE;
-
-                    // Up / Down buttons are active high (set inputObj->pressed to PUSHED if current state == 1, RELEASED if current state == 0)
-                    inputObj->input_event = inputObj->current_button_state ? PUSHED : RELEASED;
-                }
-                // Set flag for checkButtonState, indicating that button was pressed
-                inputObj->was_pressed = true;
-            }
-        } else {
-            // Set pressed status to NONE if current button state == new button state
-            inputObj->input_event = NONE;
-        }
+// Stop the sample timer and wait for the next edge
+static void stopSampling(void) {
+    uint32_t i;
+
+    TimerDisable(TIMER1_BASE, TIMER_A);
+    for (i = 0; i < NUM_INPUT_OBJS; i++) {
+        GPIOIntClear(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
+        GPIOIntEnable(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
     }
-    else if (!(inputObj->is_button)) {
-        systemStatus.system_on = GPIOPinRead(inputObj->port_base, inputObj->pin) != 0;
+    // An input that changed before its edge interrupt was re-enabled would otherwise be missed
+    if (sampleInputs() != g_debounce.state) {
+        startSampling();
     }
 }
 
-// Update all user input devices (buttons and switch)
-void updateInputs(void) {
-    updateInputObj(&g_left_button);
-    updateInputObj(&g_right_button);
-    updateInputObj(&g_up_button);
-    updateInputObj(&g_down_button);
-    updateInputObj(&g_right_switch);
+// The first edge on any input (the rest of its contact bounce is debounced) starts the sample timer
+static void inputEdgeInterrupt(void) {
+    uint32_t i;
+
+    for (i = 0; i < NUM_INPUT_OBJS; i++) {
+        GPIOIntClear(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
+    }
+    startSampling();
 }
 
-void initInputs(void) {
-    initInputObj(&g_left_button);
-    initInputObj(&g_right_button);
-    initInputObj(&g_up_button);
-    initInputObj(&g_down_button);
-    initInputObj(&g_right_switch);
+// Sample period, wake the inputs task to take the sample
+static void inputSampleInterrupt(void) {
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    vTaskNotifyGiveFromISR(g_inputsTaskHandle, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-static void inputsTask (void *pvParameters) {
-    portTickType ui16LastTime;
-    uint32_t ui32PollDelay = 10;
-    uint8_t ui8InputMessage;
+void initInputInterrupts(void) {
+    uint32_t i;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, SysCtlClockGet() / 1000 * INPUT_SAMPLE_MS);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, inputSampleInterrupt);
+    // Uses the FreeRTOS API so must be at or below configMAX_SYSCALL_INTERRUPT_PRIORITY
+    IntPrioritySet(INT_TIMER1A, configKERNEL_INTERRUPT_PRIORITY);
+    TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+
+    for (i = 0; i < NUM_INPUT_OBJS; i++) {
+        GPIOIntRegister(g_inputObjs[i]->port_base, inputEdgeInterrupt);
+        GPIOIntTypeSet(g_inputObjs[i]->port_base, g_inputObjs[i]->pin, GPIO_BOTH_EDGES);
+        GPIOIntClear(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
+        GPIOIntEnable(g_inputObjs[i]->port_base, g_inputObjs[i]->pin);
+    }
+}
+
+// Queue an input event for the control task, never waits. Returns true if it was queued.
+static bool sendInput(uint8_t ui8Source, uint32_t ui32Tick) {
+    inputEvent_t event = {
+        .tick = ui32Tick,
+        .source = ui8Source
+    };
+
+    if (xQueueSend(g_InputQueue, &event, 0) != pdPASS) {
+        // The control task drains the queue on every wakeup, so only count the drop
+        g_inputDrops++;
+        return false;
+    }
+    return true;
+}
+
+// Queue a device ID for each button in a mask, counting from the ID of the left button
+static bool sendButtons(uint32_t buttons, uint8_t ui8LeftID, uint32_t ui32Tick) {
+    bool sent = false;
+    uint8_t i;
+
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        if (buttons & (1u << i)) {
+            sent |= sendInput(ui8LeftID + i, ui32Tick);
+        }
+    }
+    return sent;
+}
+
+// Print the name of each button in a mask with what happened to it
+static void printButtons(uint32_t buttons, const char *action) {
+    uint8_t i;
 
-    ui16LastTime = xTaskGetTickCount();
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        if (buttons & (1u << i)) {
+            // Guard UART from concurrent access.
+            xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
+            UARTprintf("%s Button is %s.\n", g_buttonNames[i], action);
+            xSemaphoreGive(g_UARTMutex);
+        }
+    }
+}
+
+static void inputsTask (void *pvParameters) {
+    debounceEvents_t events;
+    uint8_t i;
 
     while(1)
     {
-        updateInputs();
-
-        bool leftButtonPressed = checkButtonState(&g_left_button);
-        bool rightButtonPressed = checkButtonState(&g_right_button);
-        bool upButtonPressed = checkButtonState(&g_up_button);
-        bool downButtonPressed = checkButtonState(&g_down_button);
+        // Sleep until the sample timer, which only runs after an input edge
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        if(systemStatus.state == IDLE || systemStatus.state == FLYING) {
-            if(leftButtonPressed) {
-                ui8InputMessage = LEFT_BUTTON;
+        uint32_t ui32Now = xTaskGetTickCount();
+        debounceUpdate(&g_debounce, sampleInputs(), &events);
 
-                // Guard UART from concurrent access.
-                xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
-                UARTprintf("Left Button is pressed.\n");
-                xSemaphoreGive(g_UARTMutex);
-            }
-            else if(rightButtonPressed) {
-                ui8InputMessage = RIGHT_BUTTON;
+        // Only publish switch changes, each publish wakes the control task
+        if ((events.pressed | events.released) & INPUT_SWITCH) {
+            g_inputStatus.system_on = (g_debounce.state & INPUT_SWITCH) != 0;
+            busPublish(TOPIC_INPUTS, &g_inputStatus);
+        }
 
-                // Guard UART from concurrent access.
-                xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
-                UARTprintf("Right Button is pressed.\n");
-                xSemaphoreGive(g_UARTMutex);
+        // Every event is queued, the flight state machine ignores (and counts) the ones the state has no use for
+        bool sent = sendButtons(events.pressed & INPUT_BUTTONS, LEFT_BUTTON, ui32Now);
+        sent |= sendButtons(events.longPress | events.repeat, LEFT_BUTTON_HELD, ui32Now);
+        for (i = 0; i < sizeof(g_chords) / sizeof(g_chords[0]); i++) {
+            if (events.chord == g_chords[i]) {
+                sent |= sendInput(g_chordIDs[i], ui32Now);
             }
-            else if(upButtonPressed) {
-                ui8InputMessage = UP_BUTTON;
+        }
 
-                // Guard UART from concurrent access.
-                xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
-                UARTprintf("Up Button is pressed.\n");
-                xSemaphoreGive(g_UARTMutex);
-            }
-            else if(downButtonPressed) {
-                ui8InputMessage = DOWN_BUTTON;
+        // Wake the control task to handle what was queued
+        if (sent) {
+            controlNotify(CONTROL_EVENT_INPUT);
+        }
 
-                // Guard UART from concurrent access.
+        // Logging waits for the UART, so only after the events are on their way
+        printButtons(events.pressed & INPUT_BUTTONS, "pressed");
+        printButtons(events.longPress, "held");
+        for (i = 0; i < sizeof(g_chords) / sizeof(g_chords[0]); i++) {
+            if (events.chord == g_chords[i]) {
                 xSemaphoreTake(g_UARTMutex, portMAX_DELAY);
-                UARTprintf("Down Button is pressed.\n");
+                UARTprintf("%s chord is pressed.\n", g_chordNames[i]);
                 xSemaphoreGive(g_UARTMutex);
             }
-            else {
-                ui8InputMessage = NO_INPUT;
-            }
         }
-        // Add the input message to the userInputADCQueue.
-        if(xQueueSend(g_InputQueue, &ui8InputMessage, portMAX_DELAY) != pdPASS) {
-            // Error. The queue should never be full. If so print the error message on UART and wait forever.
-            xSemaphoreTake (g_UARTMutex, portMAX_DELAY);
-            UARTprintf("\nInputs queue full.\n");
-            xSemaphoreGive (g_UARTMutex);
-            while(1){
-            }
+
+        if (debounceIdle(&g_debounce)) {
+            stopSampling();
         }
-        // Wait for the required amount of tick, ensure a constant execution frequency
-        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
     }
 }
+
+uint32_t inputDrops(void) {
+    return g_inputDrops;
+}
+
 /* initialize the input task with set periority task and stack size*/
 uint32_t initInputTask (void) {
     initInputs();
 
-    g_InputQueue = xQueueCreate(10, sizeof(uint8_t));
+    g_InputQueue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(inputEvent_t));
 
-    if (xTaskCreate (inputsTask, (const portCHAR *)"UserInputs", 128, NULL, PRIORITY_INPUT_TASK, NULL) != pdTRUE) {
+    if (xTaskCreate (inputsTask, (const portCHAR *)"UserInputs", 128, NULL, PRIORITY_INPUT_TASK, &g_inputsTaskHandle) != pdTRUE) {
         return (1);
     }
+    // Only enabled once the task exists, the debounce interrupt notifies it
+    initInputInterrupts();
     UARTprintf(" User inputs initialized \n");
     return (0);
 }
@@ -10,45 +10,46 @@
 #define USERINPUTS_H_
 
 
-/**
- * @enum            input_events.
- * @brief           Categorize input event types.
-*/
-typedef enum input_events {
-    RELEASED = 0,
-    PUSHED,
-    SWITCH_ON,
-    SWITCH_OFF, 
-    NONE
-} input_event_t;
-
-
 /**
  * @enum            inputDevice_ID.
- * @brief           For adding unique input event identifiers to the queue.
+ * @brief           For adding unique input event identifiers to the queue. Share their values with the flight events.
 */
 typedef enum inputDevice_ID {
     NO_INPUT = 0, 
     LEFT_BUTTON,
     RIGHT_BUTTON,
     UP_BUTTON,
-    DOWN_BUTTON
+    DOWN_BUTTON,
+    UP_DOWN_CHORD,
+    LEFT_RIGHT_CHORD,
+    LEFT_BUTTON_HELD,       // Long press or auto repeat, kept apart from presses so only flight steps on them
+    RIGHT_BUTTON_HELD,
+    UP_BUTTON_HELD,
+    DOWN_BUTTON_HELD
 } input_device_t;
 
 
+/**
+ * @struct          inputEvent_t.
+ * @brief           Entry on g_InputQueue, one per button press, long press, repeat or chord.
+ *
+ * @param tick      Tick count when the debounced event was detected, for measuring input to action latency.
+ * @param source    Input device ID (input_device_t) the event came from.
+*/
+typedef struct _inputEvent_t {
+    uint32_t tick;
+    uint8_t source;
+} inputEvent_t;
+
+// Input events g_InputQueue can hold before new ones are dropped
+#define INPUT_QUEUE_LENGTH  10
+
+
 /**
  * @struct                      userInput_t.
- * @brief                       Contains all input object's properties.
- * @brief                       All properties of an input object (is_button, is_right_button, is_portf, ...) are stored in this structure.
+ * @brief                       Contains an input object's pin configuration.
  * 
- * @param is_button             Object is button.     
- * @param is_right_button       Object is right_button.
- * @param is_portf              Object is on Tiva PORTF.
- * @param status                Object status.
- * @param current_button_state  Current button state (LOW / HIGH).
- * @param was_pressed           Button was pressed flag.
- * @param input_event           Instance of input_events structure, storing event type.
- * @param debounce_counter      Counter for debouncing input object.
+ * @param is_right_button       Object is right_button (PF0, needs unlocking).
  * 
  * Params for SysCtl / GPIO initialization and configuration
  * @param periph                Input object interface peripheral
@@ -58,14 +59,7 @@ typedef enum inputDevice_ID {
  * @param gpio_pin_type         Input object pin type
 */
 typedef struct _userInput_t {
-    bool is_button;
     bool is_right_button;
-    bool is_portf;     // For Left / Right button inputs
-    bool status;
-    bool current_button_state;
-    bool was_pressed;
-    input_event_t input_event;
-    uint8_t debounce_counter;
     uint32_t periph;
     uint32_t port_base;
     uint32_t pin;
@@ -73,6 +67,22 @@ typedef struct _userInput_t {
     uint32_t gpio_pin_type;
 } userInput_t;
 
+// Input bits, as sampled by sampleInputs. Buttons are in input_device_t order starting at LEFT_BUTTON.
+#define INPUT_LEFT      (1u << 0)
+#define INPUT_RIGHT     (1u << 1)
+#define INPUT_UP        (1u << 2)
+#define INPUT_DOWN      (1u << 3)
+#define INPUT_SWITCH    (1u << 4)
+#define INPUT_BUTTONS   (INPUT_LEFT | INPUT_RIGHT | INPUT_UP | INPUT_DOWN)
+#define NUM_BUTTONS     4
+
+// Inputs are sampled this often (ms) from an edge until they are idle, and change after 4 matching samples
+#define INPUT_SAMPLE_MS     4
+
+// Buttons held this long (ms) give a long press, then auto repeat this often (ms)
+#define INPUT_LONG_PRESS_MS 500
+#define INPUT_REPEAT_MS     150
+
 // LEFT button (Tiva Launchpad)
 #define LEFT_BUT_PERIPH  SYSCTL_PERIPH_GPIOF
 #define LEFT_BUT_PORT_BASE  GPIO_PORTF_BASE
@@ -108,7 +118,7 @@ typedef struct _userInput_t {
 #define RIGHT_SW_GPIO_STRENGTH GPIO_STRENGTH_2MA
 #define RIGHT_SW_GPIO_PIN_TYPE GPIO_PIN_TYPE_STD_WPD
 
-extern xQueueHandle g_userInputADCQueue;
+extern xQueueHandle g_InputQueue;
 
 
 /**
@@ -121,42 +131,43 @@ void initInputObj(userInput_t *inputObj);
 
 
 /**
- * @function        checkButtonState.
- * @brief           Check state of button object, returning true if the button was pushed.
- * @param inputObj  Pointer to an input structure (specific to buttons).
- * @returns         bool: 1 if button was pushed, else 0.
+ * @function        sampleInputs.
+ * @brief           Read every input pin, one GPIO read per port.
+ * @returns         uint32_t: INPUT_ bits of the inputs currently active.
 */
-bool checkButtonState(userInput_t *inputObj);
+uint32_t sampleInputs(void);
 
 
 /**
- * @function        updateInputObj
- * @brief           Updates input object struct members and performs debouncing.
- * @param inputObj  Pointer to an input structure.
+ * @function        initInputs.
+ * @brief           Initialize input objects using initInputObj and start the debouncer from the current input levels.
 */
-void updateInputObj(userInput_t *inputObj);
+void initInputs(void);
 
 
 /**
- * @function        updateInputs.
- * @brief           Update all input objects using updateInputObj.
+ * @function        initInputInterrupts.
+ * @brief           Enable edge interrupts on every input pin and the sample timer (TIMER1A) they start.
+ * @brief           The timer wakes the inputs task, so it must be created first.
 */
-void updateInputs(void);
+void initInputInterrupts(void);
 
 
 /**
- * @function        initInputs.
- * @brief           Initialize input objects using initInputObj.
+ * @function            inputsTask.
+ * @brief               inputsTask to be scheduled by FreeRTOS, debounces each sample taken after an input edge
+ *                      and adds input events to the input queues.
+ * @param pvParameters  Pointer to task parameters (NULL).
 */
-void initInputs(void);
+static void inputsTask (void *pvParameters);
 
 
 /**
- * @function            inputsTask.
- * @brief               inputsTask to be scheduled by FreeRTOS, checks for user input and adds input events to the input queues.
- * @param pvParameters  Pointer to task parameters (NULL).
+ * @function        inputDrops.
+ * @brief           Number of input events dropped because g_InputQueue was full.
+ * @returns         uint32_t: Events dropped since power-up.
 */
-static void inputsTask (void *pvParameters);
+uint32_t inputDrops(void);
 
 
 /**
@@ -1,7 +1,7 @@
 /*
  * yaw.c
  *
- * Yaw interrupt functions, updates current yaw value in systemStatus struct
+ * Yaw interrupt functions, keeps the raw yaw count and publishes yaw in degrees
  *
  * T3 Project Group 6 2021
  */
@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 
@@ -22,18 +23,41 @@
 #include "semphr.h"
 #include "task.h"
 
+#include "autotune.h"
+#include "bus.h"
+#include "control.h"
+#include "feedforward.h"
 #include "pid.h"
 #include "priorities.h"
 #include "shared.h"
+#include "stateFeedback.h"
+#include "sysid.h"
 #include "yaw.h"
 
-extern systemState systemStatus;
-
 extern pid_struct tail_rotor;
 
-xSemaphoreHandle g_yawCalibrated;
+extern controller_t g_tailController;
+extern sf_struct tail_state_feedback;
+
+/* set up the main to tail torque feedforward. Off (all zero) until Kbias / Kmain / Krate are
+   fitted from a main rotor SYSID run with tools/sysid_fit.py, which prints this initialiser*/
+feedforward_struct tail_feedforward = {
+    .Kbias = 0,
+    .Kmain = 0,
+    .Krate = 0,
+    .rate_alpha = 0.2,
+    .prev_main = 0,
+    .rate = 0
+};
+
+yawDriftStats_t g_yawDrift;
 
-extern xSemaphoreHandle g_StatusMutex;
+// Raw quadrature count, only written by the yaw interrupts (and yawRestoreReference with them disabled)
+static volatile uint32_t g_yawCount = 0;
+
+// Count when the reference slot was entered, the slot centre is taken halfway to the count it is left at
+static uint32_t g_yawSlotEntry;
+static bool g_yawInSlot = false;
 
 // Decode yaw based on the method proposed by ENCE464 tutor Ben Mitchell
 // THIS IS UNTESTED AS WE WERE ONLY DOING HEIGHT BEFORE 2021 LOCKDOWN
@@ -71,24 +95,138 @@ void initYawSensor(void) {
 // Initialize yaw interrupts
 void initYawInterrupt(void) {
     GPIOIntRegister(GPIO_PORTB_BASE, yawInterrupt);
+    // Same priority as the reference interrupt so neither can preempt the other part way through updating g_yawCount
+    IntPrioritySet(INT_GPIOB, configKERNEL_INTERRUPT_PRIORITY);
     GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_INT_PIN_0 | GPIO_INT_PIN_1, GPIO_BOTH_EDGES);
     GPIOIntEnable(GPIO_PORTB_BASE, GPIO_INT_PIN_0 | GPIO_INT_PIN_1);
 
     GPIOIntRegister(GPIO_PORTC_BASE, yawReferenceInterrupt);
-    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_INT_PIN_4, GPIO_FALLING_EDGE);
+    // Notifies the control task so must be at or below configMAX_SYSCALL_INTERRUPT_PRIORITY
+    IntPrioritySet(INT_GPIOC, configKERNEL_INTERRUPT_PRIORITY);
+    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_INT_PIN_4, GPIO_BOTH_EDGES);
     GPIOIntEnable(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
 }
 
 void yawInterrupt(void) {
     bool a = GPIOIntStatus(GPIO_PORTB_BASE, GPIO_PIN_0);
     bool b = GPIOIntStatus(GPIO_PORTB_BASE, GPIO_PIN_1);
-    systemStatus.currentYaw += decodeYaw(a, b);
+    g_yawCount += decodeYaw(a, b);
     GPIOIntClear(GPIO_PORTB_BASE, GPIO_INT_PIN_0 | GPIO_INT_PIN_1);
 }
 
-void yawReferenceInterrupt(void) {
-    xSemaphoreGiveFromISR(g_yawCalibrated, NULL);
+uint32_t yawCount(void) {
+    return g_yawCount;
+}
+
+int32_t yawWrapDegrees(int32_t degrees) {
+    degrees %= 360;
+    if (degrees >= 180) {
+        degrees -= 360;
+    } else if (degrees < -180) {
+        degrees += 360;
+    }
+    return degrees;
+}
+
+float yawNearest(float yaw, float reference) {
+    float error = yaw - reference;
+
+    while (error >= 180) {
+        error -= 360;
+    }
+    while (error < -180) {
+        error += 360;
+    }
+    return reference + error;
+}
+
+/* Work out how far the count at the slot centre is from a whole number of revolutions, in
+   the range -YAW_COUNTS_PER_REV/2 to YAW_COUNTS_PER_REV/2, and remove it. The number of full
+   turns is kept so the yaw still unwinds correctly when the heli turns back. */
+static int32_t yawSnapToRevolution(volatile uint32_t *yawCount, uint32_t slotCentre) {
+    int32_t drift = (int32_t)slotCentre % YAW_COUNTS_PER_REV;
+
+    if (drift >= YAW_COUNTS_PER_REV / 2) {
+        drift -= YAW_COUNTS_PER_REV;
+    } else if (drift < -(YAW_COUNTS_PER_REV / 2)) {
+        drift += YAW_COUNTS_PER_REV;
+    }
+    *yawCount -= drift;
+    return drift;
+}
+
+// Count at the middle of the reference slot, the same whichever way the heli turned through it
+static uint32_t yawSlotCentre(uint32_t slotEntry, uint32_t slotExit) {
+    return slotEntry + (int32_t)(slotExit - slotEntry) / 2;
+}
+
+int32_t yawIndexResync(yawDriftStats_t *stats, volatile uint32_t *yawCount, uint32_t slotEntry) {
+    uint32_t slotWidth = abs((int32_t)(*yawCount - slotEntry));
+    int32_t drift = yawSnapToRevolution(yawCount, yawSlotCentre(slotEntry, *yawCount));
+
+    uint32_t absDrift = abs(drift);
+    stats->revolutions++;
+    stats->lastDrift = drift;
+    stats->slotWidth = slotWidth;
+    stats->totalDrift += absDrift;
+    if (absDrift > stats->maxDrift) {
+        stats->maxDrift = absDrift;
+    }
+    // Turning back inside the slot puts the centre up to half the slot width out, so that is not a slip
+    if (absDrift > YAW_SLIP_THRESHOLD + slotWidth) {
+        stats->slips++;
+    }
+    return drift;
+}
+
+bool yawRestoreReference(int32_t yawOffset) {
+    bool restored = false;
+
     GPIOIntDisable(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
+    // A count zeroed by a real reference pulse is better than the stored offset
+    if (!g_yawDrift.indexSeen) {
+        g_yawCount = yawOffset;
+        g_yawDrift.indexSeen = true;
+        g_yawDrift.restored = true;
+        restored = true;
+    }
+    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
+    return restored;
+}
+
+/* The reference stays enabled after calibration. The first pass through the slot defines zero yaw
+   at its centre, every pass after that is used to correct any counts gained or lost since. The slot
+   is entered on one edge and left on the other, which edge comes first depends on the direction, so
+   both are used. */
+void yawReferenceInterrupt(void) {
+    GPIOIntClear(GPIO_PORTC_BASE, GPIO_INT_PIN_4);
+
+    if (GPIOPinRead(GPIO_PORTC_BASE, GPIO_PIN_4) == 0) {
+        // The sensor reads low over the slot
+        g_yawSlotEntry = g_yawCount;
+        g_yawInSlot = true;
+        return;
+    }
+    if (!g_yawInSlot) {
+        // Left a slot that was entered before the interrupt was enabled
+        return;
+    }
+    g_yawInSlot = false;
+
+    if (!g_yawDrift.indexSeen) {
+        g_yawCount -= yawSlotCentre(g_yawSlotEntry, g_yawCount);
+        g_yawDrift.indexSeen = true;
+        controlNotifyFromISR(CONTROL_EVENT_YAW_CALIBRATED);
+    }
+    else if (g_yawDrift.restored) {
+        // First pass since the count was restored, any error is the rig having been moved
+        // while it was off rather than an encoder slip
+        g_yawDrift.restored = false;
+        g_yawDrift.restoreError = yawSnapToRevolution(&g_yawCount, yawSlotCentre(g_yawSlotEntry, g_yawCount));
+    }
+    else {
+        yawIndexResync(&g_yawDrift, &g_yawCount, g_yawSlotEntry);
+    }
 }
 
 static void yawTask (void *pvParameters) {
@@ -96,18 +234,44 @@ static void yawTask (void *pvParameters) {
   //Set up parameters
     portTickType ui16LastTime;
     uint32_t ui32PollDelay = 10;
+    yawStatus_t yaw = {0};
+    uint8_t ui8TailDuty = 0;
+    uint8_t ui8MainDuty;
+    flightStatus_t flight;
     ui16LastTime = xTaskGetTickCount();
 
     while(1){
-        xSemaphoreTake(g_StatusMutex, portMAX_DELAY);
-        systemStatus.currentYawDegrees = ((systemStatus.currentYaw * ((45 << 8) / 56)) >> 8);
-        //Calculate the current Yaw values in degrees
-        systemStatus.tailPWMDuty = pid(systemStatus.currentYawDegrees, systemStatus.targetYaw, 0.01, &tail_rotor);
-        //Calculate the duty cycle for the tail PWM
-        xSemaphoreGive(g_StatusMutex);
-    }
-    vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
-    // Wait for the required amount of tick, ensure a constant execution frequency
+        busRead(TOPIC_STATE, &flight);
+        busRead(TOPIC_MAIN_DUTY, &ui8MainDuty);
+        yaw.currentYawDegrees = yawWrapDegrees((int32_t)yawCount() * 45 / 56);
+        //Calculate the current Yaw values in degrees, the count is signed (negative is anticlockwise of the reference)
+        busPublish(TOPIC_YAW, &yaw);
+
+        if (autotuneTailDuty(yaw.currentYawDegrees, xTaskGetTickCount() * portTICK_RATE_MS, &ui8TailDuty)) {
+            //the autotune relay is driving the tail rotor
+        } else if (isFlightState(flight.state)) {
+            float tailOffset = torqueFeedforward(ui8MainDuty, 0.01, &tail_feedforward);
+            //Cancel the main rotor reaction torque before it shows up as a yaw error
+            tailOffset += sysidExcitation(SYSID_TAIL, xTaskGetTickCount() * portTICK_RATE_MS);
+            //Add any identification excitation
+            float yawMeasured = yawNearest(yaw.currentYawDegrees, flight.refYaw);
+            //Measure from the setpoint the short way round, so crossing +-180 isn't a full turn of error
+            if (g_tailController == CTRL_STATE_FEEDBACK) {
+                ui8TailDuty = stateFeedback(yawMeasured, flight.refYaw, tailOffset, 0.01, &tail_state_feedback);
+            } else {
+                ui8TailDuty = pidFeedforward(yawMeasured, flight.refYaw, tailOffset, 0.01, &tail_rotor);
+            }
+            //Calculate the duty cycle for the tail PWM with the selected controller
+        } else {
+            ui8TailDuty = (flight.state == CALIBRATE) ? YAW_CALIBRATE_DUTY : 0;
+            //Spin slowly to find the reference slot while calibrating, otherwise the tail rotor is off
+            resetFeedforward(ui8MainDuty, &tail_feedforward);
+            resetStateFeedback(yaw.currentYawDegrees, &tail_state_feedback);
+        }
+        busPublish(TOPIC_TAIL_DUTY, &ui8TailDuty);
+        vTaskDelayUntil(&ui16LastTime, ui32PollDelay / portTICK_RATE_MS);
+        // Wait for the required amount of tick, ensure a constant execution frequency
+    }
 }
 
 /* initialize the Yaw task with set task priority and stack size*/
@@ -115,8 +279,6 @@ uint32_t initYawTask (void) {
     initYawSensor();
     initYawInterrupt();
 
-    g_yawCalibrated = xSemaphoreCreateBinary();
-
     if (xTaskCreate (yawTask, (const portCHAR *)"Yaw", 128, NULL, PRIORITY_YAW_TASK, NULL) != pdTRUE) {
         return (1);
     }
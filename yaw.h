@@ -9,6 +9,45 @@
 #ifndef YAW_H_
 #define YAW_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
+// Quadrature counts for one full revolution of the rig (112 slots x 4 edges / 360 degrees = 45 / 56)
+#define YAW_COUNTS_PER_REV  448
+
+// Index drift (in counts) beyond the reference slot width above which a revolution is flagged as an encoder slip
+#define YAW_SLIP_THRESHOLD  4
+
+// Tail duty (%) while turning to find the reference slot
+#define YAW_CALIBRATE_DUTY  20
+
+
+/**
+ * @struct                  yawDriftStats_t.
+ * @brief                   Per-revolution statistics gathered at each yaw reference (index) pulse.
+ *
+ * @param indexSeen         Reference pulse has been seen at least once, yaw count is referenced to it.
+ * @param restored          Yaw count was restored from a stored offset and no reference pulse has checked it yet.
+ * @param restoreError      Count error in the restored offset, found at the first reference pulse after restoring.
+ * @param revolutions       Number of index pulses seen since the first (full revolutions tracked).
+ * @param lastDrift         Count error found at the most recent index pulse (removed when re-zeroing).
+ * @param slotWidth         Counts between entering and leaving the reference slot on the most recent pass.
+ * @param maxDrift          Largest absolute count error seen at any index pulse.
+ * @param totalDrift        Sum of absolute count errors, total accumulated drift corrected.
+ * @param slips             Number of revolutions where |lastDrift| exceeded YAW_SLIP_THRESHOLD plus slotWidth.
+*/
+typedef struct _yawDriftStats_t {
+    bool indexSeen;
+    bool restored;
+    int32_t restoreError;
+    uint32_t revolutions;
+    int32_t lastDrift;
+    uint32_t slotWidth;
+    uint32_t maxDrift;
+    uint32_t totalDrift;
+    uint32_t slips;
+} yawDriftStats_t;
+
 
 /**
  * @enum            yawResult.
@@ -46,21 +85,76 @@ void initYawInterrupt(void);
 
 /**
  * @function        yawInterrupt.
- * @brief           Handle yaw interrupts, decoding yaw and modifying systemStatus.
+ * @brief           Handle yaw interrupts, decoding yaw and updating the raw yaw count.
 */
 void yawInterrupt(void);
 
 
+/**
+ * @function        yawCount.
+ * @brief           Read the raw quadrature yaw count, updated by the yaw interrupts.
+ * @returns         uint32_t: Yaw count relative to the reference slot.
+*/
+uint32_t yawCount(void);
+
+
+/**
+ * @function        yawWrapDegrees.
+ * @brief           Wrap a yaw angle or yaw difference into -180 to 179 degrees.
+ * @param degrees   Angle in degrees, any number of turns.
+ * @returns         int32_t: Same heading in -180 to 179.
+*/
+int32_t yawWrapDegrees(int32_t degrees);
+
+
+/**
+ * @function        yawNearest.
+ * @brief           The same heading as yaw, moved by whole turns to be within half a turn of reference.
+ *                  Lets controllers and trajectories take the short way round across +-180 degrees.
+ * @param yaw       Yaw in degrees.
+ * @param reference Angle to be near (degrees), any number of turns.
+ * @returns         float: yaw +- a multiple of 360, within 180 degrees of reference.
+*/
+float yawNearest(float yaw, float reference);
+
+
+/**
+ * @function        yawIndexResync.
+ * @brief           Snap the yaw count so the centre of the reference slot is a whole revolution and record the drift.
+ *                  Called as the slot is left. The centre is halfway between the counts the slot was entered and left
+ *                  at, so the result does not depend on which way the heli turned through it.
+ * @param stats     Pointer to the drift statistics to update.
+ * @param yawCount  Pointer to the raw quadrature yaw count to re-zero.
+ * @param slotEntry Yaw count when the slot was entered.
+ * @returns         int32_t: Count error removed from yawCount (positive if the count was ahead).
+*/
+int32_t yawIndexResync(yawDriftStats_t *stats, volatile uint32_t *yawCount, uint32_t slotEntry);
+
+
+/**
+ * @function        yawRestoreReference.
+ * @brief           Reference the yaw count to a stored offset instead of spinning to find the reference slot.
+ *                  Nothing is changed if a reference pulse has already zeroed the count. The next reference pulse
+ *                  checks the offset, snapping the count to the slot and recording the error in restoreError
+ *                  rather than as drift or a slip.
+ * @param yawOffset Yaw count relative to the reference slot.
+ * @returns         bool: true if the count was restored, false if a reference pulse had already been seen.
+*/
+bool yawRestoreReference(int32_t yawOffset);
+
+
 /**
  * @function        yawReferenceInterrupt.
- * @brief           Handle yaw reference interrupt when calibrating yaw, setting yawCalibrated semaphore flag.
+ * @brief           Handle yaw reference interrupt, on both edges of the slot. Leaving the slot the first time zeroes yaw at the
+ *                  slot centre and notifies the control task (CONTROL_EVENT_YAW_CALIBRATED), every later pass re-synchronises
+ *                  the count using yawIndexResync.
 */
 void yawReferenceInterrupt(void);
 
 
 /**
  * @function            yawTask.
- * @brief               yawTask to be scheduled by FreeRTOS, calculates current yaw in degrees and sets tailPWMDuty.
+ * @brief               yawTask to be scheduled by FreeRTOS, calculates current yaw in degrees and publishes it with the tail rotor duty.
  * @param pvParameters  Pointer to task parameters (NULL).
 */
 static void yawTask (void *pvParameters);